@@ -0,0 +1,117 @@
+#include "cached_response.h"
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+#ifdef MEDIA_SERVER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+// 64-bit FNV-1a, enough to tell library versions apart
+uint64_t fnv1a(const std::string& data) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+#ifdef MEDIA_SERVER_HAVE_ZLIB
+std::string gzipCompress(const std::string& data) {
+    z_stream stream{};
+    // windowBits 15 + 16 selects the gzip wrapper
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return "";
+    }
+
+    std::string out(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return result == Z_STREAM_END ? out : "";
+}
+#endif
+
+bool acceptsGzip(const httplib::Request& req) {
+    // Good enough for browsers and HTTP libraries; ignores q-values
+    const std::string accept = req.get_header_value("Accept-Encoding");
+    return accept.find("gzip") != std::string::npos;
+}
+
+bool etagMatches(const std::string& ifNoneMatch, const std::string& etag) {
+    if (ifNoneMatch == "*") return true;
+
+    // Comma-separated list; W/ prefixes compare weakly, which is fine for GET
+    size_t pos = 0;
+    while (pos < ifNoneMatch.size()) {
+        size_t end = ifNoneMatch.find(',', pos);
+        if (end == std::string::npos) end = ifNoneMatch.size();
+
+        std::string tag = ifNoneMatch.substr(pos, end - pos);
+        tag.erase(0, tag.find_first_not_of(" \t"));
+        tag.erase(tag.find_last_not_of(" \t") + 1);
+        if (tag.compare(0, 2, "W/") == 0) tag.erase(0, 2);
+        if (tag == etag) return true;
+
+        pos = end + 1;
+    }
+    return false;
+}
+
+} // namespace
+
+std::shared_ptr<const CachedResponse> CachedResponse::build(std::string body, std::string contentType) {
+    auto response = std::make_shared<CachedResponse>();
+
+    char etag[32];
+    std::snprintf(etag, sizeof(etag), "\"%016llx\"", static_cast<unsigned long long>(fnv1a(body)));
+    response->etag_ = etag;
+
+#ifdef MEDIA_SERVER_HAVE_ZLIB
+    std::string compressed = gzipCompress(body);
+    if (!compressed.empty() && compressed.size() < body.size()) {
+        response->gzipBody_ = std::move(compressed);
+    }
+#endif
+
+    response->body_ = std::move(body);
+    response->contentType_ = std::move(contentType);
+    return response;
+}
+
+void CachedResponse::serve(const httplib::Request& req, httplib::Response& res) const {
+    res.set_header("ETag", etag_);
+    res.set_header("Cache-Control", "no-cache");
+    if (!gzipBody_.empty()) {
+        res.set_header("Vary", "Accept-Encoding");
+    }
+
+    if (req.has_header("If-None-Match") && etagMatches(req.get_header_value("If-None-Match"), etag_)) {
+        res.status = 304;
+        return;
+    }
+
+    bool gzip = !gzipBody_.empty() && acceptsGzip(req);
+    if (gzip) {
+        res.set_header("Content-Encoding", "gzip");
+    }
+
+    // Serve through a content provider so httplib does not compress the body
+    // again on every request; the provider keeps this response alive
+    auto self = shared_from_this();
+    const std::string& body = gzip ? gzipBody_ : body_;
+    res.set_content_provider(
+        body.size(), contentType_,
+        [self, &body](size_t offset, size_t length, httplib::DataSink& sink) {
+            return sink.write(body.data() + offset, length);
+        });
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <httplib.h>
+
+// A response body serialized once and served many times.
+//
+// The gzip variant is compressed up front (when built with zlib) and the
+// strong ETag lets clients revalidate with If-None-Match for a 304, so a
+// cached response costs no serialization or compression per request.
+class CachedResponse : public std::enable_shared_from_this<CachedResponse> {
+public:
+    static std::shared_ptr<const CachedResponse> build(std::string body, std::string contentType);
+
+    const std::string& etag() const { return etag_; }
+
+    // Answer a request: 304 on a matching If-None-Match, otherwise the gzip
+    // variant if the client accepts it, else the identity body
+    void serve(const httplib::Request& req, httplib::Response& res) const;
+
+private:
+    std::string body_;
+    std::string gzipBody_;  // Empty without zlib or if compression did not help
+    std::string contentType_;
+    std::string etag_;
+};
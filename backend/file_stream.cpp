@@ -0,0 +1,124 @@
+#include "file_stream.h"
+#include <memory>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+// Open file plus its single reusable read buffer, shared by the provider
+// callbacks of one response and released when the response is finished
+struct OpenFile {
+#ifdef _WIN32
+    std::ifstream stream;
+#else
+    int fd = -1;
+#endif
+    size_t size = 0;
+    std::vector<char> buffer;
+
+    ~OpenFile() {
+#ifndef _WIN32
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    bool open(const std::string& path) {
+#ifdef _WIN32
+        stream.open(path, std::ios::binary);
+        if (!stream) return false;
+        stream.seekg(0, std::ios::end);
+        size = static_cast<size_t>(stream.tellg());
+        stream.seekg(0, std::ios::beg);
+#else
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) return false;
+        size = static_cast<size_t>(st.st_size);
+
+#ifdef __linux__
+        // Players read forward from wherever they seek to
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+#endif
+        return true;
+    }
+
+    // Read up to `length` bytes at `offset` into the buffer, returns bytes read
+    size_t read(size_t offset, size_t length) {
+#ifdef _WIN32
+        stream.clear();
+        stream.seekg(static_cast<std::streamoff>(offset));
+        stream.read(buffer.data(), static_cast<std::streamsize>(length));
+        return static_cast<size_t>(stream.gcount());
+#else
+        ssize_t n;
+        do {
+            n = ::pread(fd, buffer.data(), length, static_cast<off_t>(offset));
+        } while (n < 0 && errno == EINTR);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+#endif
+    }
+};
+
+// True if at least one requested range overlaps the file (RFC 7233 §4.4)
+bool isSatisfiable(const httplib::Ranges& ranges, size_t fileSize) {
+    for (const auto& range : ranges) {
+        if (range.first < 0) {
+            // Suffix range: last N bytes
+            if (range.second > 0 && fileSize > 0) return true;
+        } else if (static_cast<size_t>(range.first) < fileSize) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+bool FileStreamer::serve(const httplib::Request& req, httplib::Response& res,
+                         const std::string& path, const std::string& contentType) {
+    auto file = std::make_shared<OpenFile>();
+    if (!file->open(path)) {
+        std::cerr << "[Stream] ERROR: Cannot open " << path << std::endl;
+        return false;
+    }
+
+    res.set_header("Accept-Ranges", "bytes");
+
+    if (!req.ranges.empty() && !isSatisfiable(req.ranges, file->size)) {
+        res.status = 416; // Range Not Satisfiable
+        res.set_header("Content-Range", "bytes */" + std::to_string(file->size));
+        return true;
+    }
+
+    if (file->size == 0) {
+        res.set_content("", contentType);
+        return true;
+    }
+
+    file->buffer.resize(std::min(kChunkSize, file->size));
+
+    // httplib calls the provider repeatedly with absolute offsets inside the
+    // requested range; each call reads and sends at most one chunk
+    res.set_content_provider(
+        file->size, contentType,
+        [file](size_t offset, size_t length, httplib::DataSink& sink) {
+            size_t n = file->read(offset, std::min(length, file->buffer.size()));
+            if (n == 0) return false;
+            return sink.write(file->buffer.data(), n);
+        });
+
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <httplib.h>
+
+// Streams files from disk into HTTP responses without buffering them in memory
+class FileStreamer {
+public:
+    // Bytes read from disk and handed to the socket per provider call.
+    // This is the only per-connection buffer, regardless of file or range size.
+    static constexpr size_t kChunkSize = 256 * 1024;
+
+    // Attach the file as a streamed response body.
+    // The provider is registered with the full file length so httplib applies
+    // the request's Range header itself (single, open-ended, suffix and
+    // multi-range) and only asks for the bytes that actually go on the wire.
+    // Returns false if the file could not be opened; the response is untouched.
+    static bool serve(const httplib::Request& req, httplib::Response& res,
+                      const std::string& path, const std::string& contentType);
+};
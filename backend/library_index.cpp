@@ -0,0 +1,200 @@
+#include "library_index.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+// Bump kIndexVersion whenever the layout or the filename classification
+// rules change, so stale indexes are rebuilt instead of misread
+static const char kIndexMagic[8] = {'S', 'M', 'S', 'I', 'D', 'X', '\0', '\0'};
+static const uint32_t kIndexVersion = 1;
+
+namespace {
+
+// Little helpers for the flat binary layout: fixed-width integers in host
+// byte order, strings as uint32 length + bytes
+class IndexWriter {
+public:
+    void u32(uint32_t v) { raw(&v, sizeof(v)); }
+    void i32(int32_t v) { raw(&v, sizeof(v)); }
+    void i64(int64_t v) { raw(&v, sizeof(v)); }
+    void u8(uint8_t v) { raw(&v, sizeof(v)); }
+    void str(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        raw(s.data(), s.size());
+    }
+    void raw(const void* data, size_t size) {
+        buffer_.append(static_cast<const char*>(data), size);
+    }
+    const std::string& buffer() const { return buffer_; }
+
+private:
+    std::string buffer_;
+};
+
+class IndexReader {
+public:
+    explicit IndexReader(const std::string& buffer) : buffer_(buffer) {}
+
+    bool ok() const { return ok_; }
+
+    uint32_t u32() { uint32_t v = 0; raw(&v, sizeof(v)); return v; }
+    int32_t i32() { int32_t v = 0; raw(&v, sizeof(v)); return v; }
+    int64_t i64() { int64_t v = 0; raw(&v, sizeof(v)); return v; }
+    uint8_t u8() { uint8_t v = 0; raw(&v, sizeof(v)); return v; }
+    std::string str() {
+        uint32_t size = u32();
+        if (!ok_ || size > buffer_.size() - pos_) { ok_ = false; return ""; }
+        std::string s = buffer_.substr(pos_, size);
+        pos_ += size;
+        return s;
+    }
+    void raw(void* out, size_t size) {
+        if (!ok_ || size > buffer_.size() - pos_) { ok_ = false; return; }
+        std::memcpy(out, buffer_.data() + pos_, size);
+        pos_ += size;
+    }
+
+private:
+    const std::string& buffer_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+} // namespace
+
+std::optional<std::vector<ScannedDirectory>> LibraryIndex::load(const std::string& indexFile,
+                                                                const std::string& rootPath) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::ifstream file(indexFile, std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    std::string buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    IndexReader in(buffer);
+    char magic[sizeof(kIndexMagic)];
+    in.raw(magic, sizeof(magic));
+    if (!in.ok() || std::memcmp(magic, kIndexMagic, sizeof(magic)) != 0 || in.u32() != kIndexVersion) {
+        std::cerr << "[Index] Ignoring " << indexFile << " (unknown format)" << std::endl;
+        return std::nullopt;
+    }
+    if (in.str() != rootPath) {
+        std::cerr << "[Index] Ignoring " << indexFile << " (different library path)" << std::endl;
+        return std::nullopt;
+    }
+
+    std::vector<ScannedDirectory> directories(in.u32());
+    size_t fileCount = 0;
+    for (auto& dir : directories) {
+        if (!in.ok()) break;
+        dir.path = in.str();
+        dir.mtime = in.i64();
+
+        dir.subdirs.resize(in.u32());
+        for (auto& subdir : dir.subdirs) {
+            subdir = in.str();
+        }
+
+        dir.files.resize(in.u32());
+        for (auto& scanned : dir.files) {
+            scanned.video.path = in.str();
+            scanned.video.filename = in.str();
+            uint8_t flags = in.u8();
+            int32_t season = in.i32();
+            int32_t episode = in.i32();
+            if (flags & 1) scanned.video.season = season;
+            if (flags & 2) scanned.video.episode = episode;
+            scanned.seriesName = in.str();
+            scanned.movieName = in.str();
+        }
+        fileCount += dir.files.size();
+    }
+
+    if (!in.ok()) {
+        std::cerr << "[Index] Ignoring " << indexFile << " (truncated)" << std::endl;
+        return std::nullopt;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime);
+    std::cout << "[Index] Loaded " << directories.size() << " directories, " << fileCount
+              << " videos in " << elapsed.count() << "ms" << std::endl;
+
+    return directories;
+}
+
+namespace {
+
+void writeHeader(IndexWriter& out, const std::string& rootPath, size_t directoryCount) {
+    out.raw(kIndexMagic, sizeof(kIndexMagic));
+    out.u32(kIndexVersion);
+    out.str(rootPath);
+    out.u32(static_cast<uint32_t>(directoryCount));
+}
+
+void writeDirectory(IndexWriter& out, const ScannedDirectory& dir) {
+    out.str(dir.path);
+    out.i64(dir.mtime);
+
+    out.u32(static_cast<uint32_t>(dir.subdirs.size()));
+    for (const auto& subdir : dir.subdirs) {
+        out.str(subdir);
+    }
+
+    out.u32(static_cast<uint32_t>(dir.files.size()));
+    for (const auto& scanned : dir.files) {
+        out.str(scanned.video.path);
+        out.str(scanned.video.filename);
+        out.u8(static_cast<uint8_t>((scanned.video.season ? 1 : 0) | (scanned.video.episode ? 2 : 0)));
+        out.i32(scanned.video.season.value_or(0));
+        out.i32(scanned.video.episode.value_or(0));
+        out.str(scanned.seriesName);
+        out.str(scanned.movieName);
+    }
+}
+
+} // namespace
+
+bool LibraryIndex::save(const std::string& indexFile, const std::string& rootPath,
+                        const std::vector<ScannedDirectory>& directories) {
+    IndexWriter out;
+    writeHeader(out, rootPath, directories.size());
+    for (const auto& dir : directories) {
+        writeDirectory(out, dir);
+    }
+    return write(indexFile, out.buffer());
+}
+
+bool LibraryIndex::save(const std::string& indexFile, const std::string& rootPath,
+                        const std::map<std::string, ScannedDirectory>& directories) {
+    IndexWriter out;
+    writeHeader(out, rootPath, directories.size());
+    for (const auto& [path, dir] : directories) {
+        writeDirectory(out, dir);
+    }
+    return write(indexFile, out.buffer());
+}
+
+bool LibraryIndex::write(const std::string& indexFile, const std::string& data) {
+    std::string tmpFile = indexFile + ".tmp";
+    {
+        std::ofstream file(tmpFile, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(data.data(), data.size())) {
+            std::cerr << "[Index] Cannot write " << tmpFile << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmpFile, indexFile, ec);
+    if (ec) {
+        std::cerr << "[Index] Cannot replace " << indexFile << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
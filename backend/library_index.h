@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include "scanner.h"
+
+// Persistent binary snapshot of the scanned library directories.
+//
+// The index stores every directory with its mtime, child directories and
+// already-classified video files, so startup only has to read one file and
+// then re-read the directories whose mtime changed since it was written.
+class LibraryIndex {
+public:
+    // Load the directories saved for this library root. Returns nullopt if the
+    // file is missing, corrupt, from another format version or another root.
+    static std::optional<std::vector<ScannedDirectory>> load(const std::string& indexFile,
+                                                             const std::string& rootPath);
+
+    // Write the directories atomically (temporary file + rename)
+    static bool save(const std::string& indexFile, const std::string& rootPath,
+                     const std::vector<ScannedDirectory>& directories);
+    static bool save(const std::string& indexFile, const std::string& rootPath,
+                     const std::map<std::string, ScannedDirectory>& directories);
+
+private:
+    static bool write(const std::string& indexFile, const std::string& data);
+};
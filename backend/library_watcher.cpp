@@ -0,0 +1,292 @@
+#include "library_watcher.h"
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace fs = std::filesystem;
+
+// Changes are applied once no new event has arrived for this long, so that
+// copying a whole season produces one library update instead of dozens
+static const auto kSettleDelay = std::chrono::milliseconds(1000);
+static const auto kWakeInterval = std::chrono::milliseconds(250);
+
+LibraryWatcher::LibraryWatcher(VideoScanner& scanner, std::vector<ScannedDirectory> directories)
+    : scanner_(scanner) {
+    for (auto& dir : directories) {
+        std::string path = dir.path;
+        directories_[path] = std::move(dir);
+    }
+    publish();
+}
+
+LibraryWatcher::~LibraryWatcher() {
+    stopping_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+#ifdef __linux__
+    if (inotifyFd_ >= 0) {
+        ::close(inotifyFd_);
+    }
+#endif
+}
+
+std::shared_ptr<const MediaLibrary> LibraryWatcher::library() const {
+    return std::atomic_load(&library_);
+}
+
+void LibraryWatcher::setUpdateHandler(UpdateHandler handler) {
+    onUpdate_ = std::move(handler);
+}
+
+void LibraryWatcher::reconcile() {
+    auto stale = findStaleDirectories();
+    if (stale.empty()) {
+        std::cout << "[Watcher] Library index is up to date" << std::endl;
+        return;
+    }
+    applyChanges(stale);
+}
+
+void LibraryWatcher::start(std::chrono::seconds rescanInterval, bool reconcileFirst) {
+    rescanInterval_ = rescanInterval;
+    reconcileFirst_ = reconcileFirst;
+
+    if (rescanInterval_.count() > 0) {
+        std::cout << "[Watcher] Checking directory mtimes every " << rescanInterval_.count() << "s" << std::endl;
+    }
+
+    thread_ = std::thread(&LibraryWatcher::run, this);
+}
+
+void LibraryWatcher::watch(const std::string& dir) {
+#ifdef __linux__
+    if (inotifyFd_ < 0 || watchDescriptors_.count(dir)) return;
+
+    std::string path = scanner_.absoluteDirectory(dir).string();
+    int wd = ::inotify_add_watch(inotifyFd_, path.c_str(),
+        IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+    if (wd < 0) {
+        // Typically ENOSPC (fs.inotify.max_user_watches); the mtime poll still covers it
+        static bool warned = false;
+        if (!warned) {
+            std::cerr << "[Watcher] Cannot watch " << path << ": " << std::strerror(errno)
+                      << " (falling back to periodic rescans for such directories)" << std::endl;
+            warned = true;
+        }
+        return;
+    }
+
+    watchPaths_[wd] = dir;
+    watchDescriptors_[dir] = wd;
+#else
+    (void)dir;
+#endif
+}
+
+void LibraryWatcher::unwatch(const std::string& dir) {
+#ifdef __linux__
+    auto it = watchDescriptors_.find(dir);
+    if (it == watchDescriptors_.end()) return;
+
+    ::inotify_rm_watch(inotifyFd_, it->second);
+    watchPaths_.erase(it->second);
+    watchDescriptors_.erase(it);
+#else
+    (void)dir;
+#endif
+}
+
+void LibraryWatcher::run() {
+    // Registering watches touches every directory, which is slow on network
+    // shares; do it here rather than delaying startup
+#ifdef __linux__
+    inotifyFd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ < 0) {
+        std::cerr << "[Watcher] inotify unavailable, relying on periodic rescans" << std::endl;
+    } else {
+        for (const auto& [path, dir] : directories_) {
+            watch(path);
+        }
+        std::cout << "[Watcher] Watching " << watchDescriptors_.size() << " directories with inotify" << std::endl;
+    }
+#endif
+
+    // Watches go in first so changes made during the reconcile are not lost
+    if (reconcileFirst_) {
+        reconcile();
+    }
+
+    std::set<std::string> pending;
+    auto lastEvent = std::chrono::steady_clock::now();
+    auto nextRescan = lastEvent + rescanInterval_;
+
+    while (!stopping_) {
+        bool gotEvents = false;
+        bool overflow = false;
+
+#ifdef __linux__
+        if (inotifyFd_ >= 0) {
+            pollfd pfd{inotifyFd_, POLLIN, 0};
+            int ready = ::poll(&pfd, 1, static_cast<int>(kWakeInterval.count()));
+
+            if (ready > 0) {
+                alignas(inotify_event) char buffer[64 * 1024];
+                ssize_t len;
+                while ((len = ::read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+                    for (char* p = buffer; p < buffer + len; ) {
+                        auto* event = reinterpret_cast<inotify_event*>(p);
+                        p += sizeof(inotify_event) + event->len;
+
+                        if (event->mask & IN_Q_OVERFLOW) {
+                            overflow = true;
+                            continue;
+                        }
+
+                        auto it = watchPaths_.find(event->wd);
+                        if (it == watchPaths_.end()) continue;
+
+                        if (event->mask & IN_IGNORED) {
+                            // Directory is gone; its parent's event handles the library side
+                            watchDescriptors_.erase(it->second);
+                            watchPaths_.erase(it);
+                            continue;
+                        }
+
+                        pending.insert(it->second);
+                        gotEvents = true;
+                    }
+                }
+            }
+        } else
+#endif
+        {
+            std::this_thread::sleep_for(kWakeInterval);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (gotEvents) {
+            lastEvent = now;
+        }
+
+        // Lost events: fall back to comparing every directory's mtime
+        if (overflow) {
+            std::cerr << "[Watcher] inotify queue overflow, checking all directories" << std::endl;
+            auto stale = findStaleDirectories();
+            pending.insert(stale.begin(), stale.end());
+        }
+
+        if (!pending.empty() && now - lastEvent >= kSettleDelay) {
+            applyChanges(pending);
+            pending.clear();
+        }
+
+        if (rescanInterval_.count() > 0 && now >= nextRescan) {
+            auto stale = findStaleDirectories();
+            if (!stale.empty()) {
+                applyChanges(stale);
+            }
+            nextRescan = now + rescanInterval_;
+        }
+    }
+}
+
+std::set<std::string> LibraryWatcher::findStaleDirectories() const {
+    std::set<std::string> stale;
+    for (const auto& [path, dir] : directories_) {
+        auto mtime = scanner_.directoryMtime(path);
+        if (!mtime || *mtime != dir.mtime) {
+            stale.insert(path);
+        }
+    }
+    return stale;
+}
+
+void LibraryWatcher::applyChanges(const std::set<std::string>& changed) {
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<std::string> added;
+    size_t reread = 0;
+
+    for (const auto& path : changed) {
+        auto it = directories_.find(path);
+        if (it == directories_.end()) continue;  // removed along with an ancestor
+
+        // A vanished directory is dropped when its parent is re-read
+        if (!scanner_.directoryMtime(path)) continue;
+
+        ScannedDirectory fresh = scanner_.scanDirectory(path);
+        reread++;
+
+        std::set<std::string> oldSubdirs(it->second.subdirs.begin(), it->second.subdirs.end());
+        std::set<std::string> newSubdirs(fresh.subdirs.begin(), fresh.subdirs.end());
+
+        for (const auto& subdir : oldSubdirs) {
+            if (!newSubdirs.count(subdir)) removeSubtree(subdir);
+        }
+        for (const auto& subdir : newSubdirs) {
+            if (!oldSubdirs.count(subdir)) added.push_back(subdir);
+        }
+
+        it->second = std::move(fresh);
+    }
+
+    // Add new subtrees only after every removal: a renamed directory keeps
+    // its inotify watch descriptor, which must be released from the old path
+    for (const auto& subdir : added) {
+        addSubtree(subdir);
+    }
+
+    if (reread == 0) return;
+
+    publish();
+    if (onUpdate_) {
+        onUpdate_(directories_);
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime);
+    std::cout << "[Watcher] Re-read " << reread << " directories (" << added.size()
+              << " new subtrees) in " << elapsed.count() << "ms" << std::endl;
+}
+
+void LibraryWatcher::removeSubtree(const std::string& dir) {
+    const std::string prefix = dir + static_cast<char>(fs::path::preferred_separator);
+
+    unwatch(dir);
+    directories_.erase(dir);
+
+    // Paths with a common prefix are contiguous in the ordered map
+    auto it = directories_.lower_bound(prefix);
+    while (it != directories_.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        unwatch(it->first);
+        it = directories_.erase(it);
+    }
+}
+
+void LibraryWatcher::addSubtree(const std::string& dir) {
+    std::vector<std::string> queue = {dir};
+
+    while (!queue.empty()) {
+        std::string path = std::move(queue.back());
+        queue.pop_back();
+        if (directories_.count(path)) continue;
+
+        // Watch before reading so nothing created in between is missed
+        watch(path);
+        ScannedDirectory scanned = scanner_.scanDirectory(path);
+        queue.insert(queue.end(), scanned.subdirs.begin(), scanned.subdirs.end());
+        directories_[path] = std::move(scanned);
+    }
+}
+
+void LibraryWatcher::publish() {
+    auto library = std::make_shared<const MediaLibrary>(VideoScanner::buildLibrary(directories_));
+    std::atomic_store(&library_, library);
+}
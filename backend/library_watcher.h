@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include "scanner.h"
+
+// Keeps the library in sync with the filesystem after the initial scan.
+//
+// Changes are detected per directory, with inotify on Linux and by comparing
+// directory mtimes on a timer everywhere (network filesystems don't deliver
+// inotify events for changes made by other machines). Only the changed
+// directories are re-read; the library is then rebuilt from the in-memory
+// directory map and published as a new immutable snapshot.
+class LibraryWatcher {
+public:
+    LibraryWatcher(VideoScanner& scanner, std::vector<ScannedDirectory> directories);
+    ~LibraryWatcher();
+
+    LibraryWatcher(const LibraryWatcher&) = delete;
+    LibraryWatcher& operator=(const LibraryWatcher&) = delete;
+
+    // Current library snapshot. Readers never wait for updates; a snapshot
+    // stays valid for as long as the caller holds it.
+    std::shared_ptr<const MediaLibrary> library() const;
+
+    // Called on the watcher thread with the directory map after every
+    // published update (used to keep the on-disk index current)
+    using UpdateHandler = std::function<void(const std::map<std::string, ScannedDirectory>&)>;
+    void setUpdateHandler(UpdateHandler handler);
+
+    // Re-read every directory whose mtime changed since it was read. Used when
+    // the initial directories came from a saved index; call before start().
+    void reconcile();
+
+    // Start the watcher thread. rescanInterval controls the mtime poll
+    // (zero disables it and relies on inotify alone). With reconcileFirst the
+    // thread begins with reconcile(), so startup does not wait for it.
+    void start(std::chrono::seconds rescanInterval, bool reconcileFirst = false);
+
+private:
+    void run();
+
+    // Re-read the given directories, following added/removed subdirectories
+    void applyChanges(const std::set<std::string>& changed);
+    void removeSubtree(const std::string& dir);
+    void addSubtree(const std::string& dir);
+
+    // Directories whose mtime no longer matches what was read
+    std::set<std::string> findStaleDirectories() const;
+
+    // Rebuild the library from the directory map and swap it in
+    void publish();
+
+    void watch(const std::string& dir);
+    void unwatch(const std::string& dir);
+
+    VideoScanner& scanner_;
+    std::map<std::string, ScannedDirectory> directories_;  // owned by the watcher thread
+    std::shared_ptr<const MediaLibrary> library_;          // swapped with std::atomic_store
+    UpdateHandler onUpdate_;
+
+    std::chrono::seconds rescanInterval_{0};
+    bool reconcileFirst_ = false;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+
+#ifdef __linux__
+    int inotifyFd_ = -1;
+    std::map<int, std::string> watchPaths_;        // watch descriptor -> directory
+    std::map<std::string, int> watchDescriptors_;  // directory -> watch descriptor
+#endif
+};
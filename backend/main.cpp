@@ -6,29 +6,69 @@
 #include <cstdlib>
 #include <sstream>
 #include <thread>
+#include <chrono>
 #include <mutex>
 #include <map>
 #include "scanner.h"
+#include "library_watcher.h"
+#include "library_index.h"
 #include "video_info.h"
+#include "file_stream.h"
+#include "cached_response.h"
+#include "transcode_jobs.h"
+#include "transcode_scheduler.h"
+#include "transcode_cache.h"
 
 namespace fs = std::filesystem;
 using json = nlohmann::json;
 
-// HLS cache for generated segments
-struct HLSCache {
-    std::mutex mutex;
-    std::map<std::string, std::string> playlists; // video_path -> m3u8 content
-    std::map<std::string, fs::path> segmentDirs;  // video_path -> segment directory
-};
+// How long a playlist request waits for ffmpeg to produce the first segment
+static const auto kHLSFirstSegmentTimeout = std::chrono::seconds(30);
+// How long a segment request waits for a segment that is still being encoded
+static const auto kHLSSegmentTimeout = std::chrono::seconds(20);
+static const auto kHLSPollInterval = std::chrono::milliseconds(100);
+// How long a new job may sit in the scheduler queue before the request is
+// answered with 503 + queue position instead of holding the connection
+static const auto kQueuedJobWait = std::chrono::seconds(1);
+// Upper bound for a request waiting on a full legacy MP4 transcode
+static const auto kLegacyTranscodeTimeout = std::chrono::hours(6);
+
+// Transcode settings folded into cache keys; change these whenever the
+// ffmpeg arguments below change so stale renditions are not reused
+static const char* kHLSCacheParameters = "hls:mpegts:4s:v1";
+static const char* kLegacyCacheParameters = "legacy:mp4:baseline:3.1:crf23:v1";
+
+// Read the playlist ffmpeg is writing, or return empty if it has no segment yet.
+// The playlist is an EVENT playlist that keeps growing until ffmpeg finishes;
+// EXT-X-START pins playback to the beginning instead of the live edge.
+std::string readProgressivePlaylist(const fs::path& segmentDir) {
+    std::ifstream playlistFile(segmentDir / "playlist.m3u8");
+    if (!playlistFile) {
+        return "";
+    }
 
-// Legacy compatible video cache
-struct LegacyCache {
-    std::mutex mutex;
-    std::map<std::string, fs::path> legacyFiles;  // video_path -> legacy mp4 file
-};
+    std::stringstream buffer;
+    buffer << playlistFile.rdbuf();
+    std::string content = buffer.str();
+
+    if (content.find("#EXTINF") == std::string::npos) {
+        return "";
+    }
+
+    const std::string header = "#EXTM3U\n";
+    if (content.compare(0, header.size(), header) == 0 &&
+        content.find("#EXT-X-START") == std::string::npos) {
+        content.insert(header.size(), "#EXT-X-START:TIME-OFFSET=0,PRECISE=YES\n");
+    }
+
+    return content;
+}
 
-// Generate HLS segments for a video file with smart transcoding
-bool generateHLS(const fs::path& videoPath, const fs::path& outputDir, std::string& playlistContent, bool copyVideo = false, bool copyAudio = false, int audioStream = -1, int subtitleStream = -1) {
+// Generate HLS segments for a video file with smart transcoding.
+// Blocks until ffmpeg exits; the playlist is usable as soon as its first
+// segment has been written, so callers run this on a background thread.
+// threads limits ffmpeg's encoder threads (0 = ffmpeg default).
+bool generateHLS(const fs::path& videoPath, const fs::path& outputDir, bool copyVideo = false, bool copyAudio = false, int audioStream = -1, int subtitleStream = -1, int threads = 0) {
     // Create output directory if it doesn't exist
     if (!fs::exists(outputDir)) {
         fs::create_directories(outputDir);
@@ -38,8 +78,13 @@ bool generateHLS(const fs::path& videoPath, const fs::path& outputDir, std::stri
     fs::path playlistPath = outputDir / "playlist.m3u8";
     fs::path segmentPattern = outputDir / "segment%d.ts";
 
+    // A playlist left over from an earlier run would be served as if it were
+    // the new one before ffmpeg gets to overwrite it
+    std::error_code ec;
+    fs::remove(playlistPath, ec);
+
     std::ostringstream cmd;
-    cmd << "ffmpeg -i \"" << videoPath.string() << "\" ";
+    cmd << "ffmpeg -y -i \"" << videoPath.string() << "\" ";
 
     // Select specific audio stream if specified (prioritize English)
     if (audioStream >= 0) {
@@ -47,6 +92,11 @@ bool generateHLS(const fs::path& videoPath, const fs::path& outputDir, std::stri
         cmd << "-map 0:a:" << audioStream << " ";  // Map specific audio stream
     }
 
+    // Stay within the scheduler's per-job thread budget
+    if (threads > 0) {
+        cmd << "-threads " << threads << " ";
+    }
+
     // Video codec selection
     if (copyVideo) {
         std::cout << "✓ Using stream copy for VIDEO (zero quality loss, instant!)" << std::endl;
@@ -74,7 +124,8 @@ bool generateHLS(const fs::path& videoPath, const fs::path& outputDir, std::stri
     cmd << "-start_number 0 "
         << "-hls_time 4 "
         << "-hls_list_size 0 "
-        << "-hls_flags split_by_time "
+        << "-hls_playlist_type event "         // Playlist grows while encoding
+        << "-hls_flags split_by_time+temp_file " // Segments appear only once complete
         << "-hls_segment_type mpegts "
         << "-hls_segment_filename \"" << segmentPattern.string() << "\" "
         << "-f hls ";
@@ -95,22 +146,12 @@ bool generateHLS(const fs::path& videoPath, const fs::path& outputDir, std::stri
         return false;
     }
 
-    // Read generated playlist
-    std::ifstream playlistFile(playlistPath);
-    if (!playlistFile) {
-        return false;
-    }
-
-    std::stringstream buffer;
-    buffer << playlistFile.rdbuf();
-    playlistContent = buffer.str();
-
     std::cout << "HLS generation complete: " << playlistPath << std::endl;
     return true;
 }
 
 // Generate legacy-compatible MP4 for maximum device compatibility
-bool generateLegacyMP4(const fs::path& videoPath, const fs::path& outputFile) {
+bool generateLegacyMP4(const fs::path& videoPath, const fs::path& outputFile, int threads = 0) {
     // Create output directory if it doesn't exist
     fs::path outputDir = outputFile.parent_path();
     if (!fs::exists(outputDir)) {
@@ -138,6 +179,7 @@ bool generateLegacyMP4(const fs::path& videoPath, const fs::path& outputFile) {
         << "-b:a 128k "                   // Audio bitrate
         << "-ac 2 "                       // Stereo audio (legacy devices may not support surround)
         << "-movflags +faststart "        // Enable fast start for web streaming
+        << "-threads " << threads << " "  // Scheduler thread budget (0 = auto)
         << "-f mp4 "                      // MP4 container
         << "\"" << outputFile.string() << "\" "
         << "-y "                          // Overwrite if exists
@@ -154,6 +196,68 @@ bool generateLegacyMP4(const fs::path& videoPath, const fs::path& outputFile) {
     return true;
 }
 
+// Probe a title and run its HLS transcode to completion.
+// Runs on a scheduler worker; the playlist is served while ffmpeg writes it.
+bool runHLSJob(const std::shared_ptr<TranscodeJob>& job, const fs::path& fullPath, int threads) {
+    // Analyze video to determine smart transcoding strategy
+    auto videoInfo = VideoInfoAnalyzer::analyze(fullPath.string());
+
+    bool copyVideo = false;
+    bool copyAudio = false;
+    int audioStreamIndex = -1;
+    int subtitleStreamIndex = -1;
+
+    if (videoInfo) {
+        // Selective stream copy for ZERO quality degradation
+        copyVideo = !videoInfo->needs_video_transcode;
+        copyAudio = !videoInfo->needs_audio_transcode;
+
+        std::cout << "[HLS] Smart transcoding strategy:" << std::endl;
+        std::cout << "[HLS]   Video: " << (copyVideo ? "✓ COPY (zero quality loss)" : "✗ Transcode to H.264") << std::endl;
+        std::cout << "[HLS]   Audio: " << (copyAudio ? "✓ COPY (zero quality loss)" : "✗ Transcode to AAC") << std::endl;
+
+        // Find English audio stream (prioritize English over other languages)
+        for (size_t i = 0; i < videoInfo->audio_streams.size(); i++) {
+            // Check stream metadata for language (this would need to be added to VideoCodecInfo)
+            // For now, prefer stream 1 (often English in multi-audio files) if there are multiple streams
+            if (videoInfo->audio_streams.size() > 1 && i == 1) {
+                audioStreamIndex = i;
+                std::cout << "[HLS]   Selected audio stream: " << i << " (likely English)" << std::endl;
+                break;
+            }
+        }
+
+        // Find English subtitle stream if available
+        // (Subtitle selection logic would go here if we add subtitle metadata)
+    } else {
+        std::cerr << "[HLS] WARNING: Could not analyze video, using full transcode" << std::endl;
+    }
+
+    std::cout << "[HLS] Starting HLS generation..." << std::endl;
+    bool ok = generateHLS(fullPath, job->output(), copyVideo, copyAudio, audioStreamIndex, subtitleStreamIndex, threads);
+
+    std::cout << "[HLS] HLS generation " << (ok ? "complete" : "FAILED") << ": " << job->key() << std::endl;
+    return ok;
+}
+
+// Answer a request whose transcode could not start yet: fast 503 with a
+// Retry-After hint and, if it is waiting, the job's position in the queue
+void respondTranscodeBusy(httplib::Response& res, const TranscodeScheduler& scheduler, const std::string& key) {
+    int position = scheduler.queuePosition(key);
+
+    res.status = 503;
+    res.set_header("Retry-After", std::to_string(scheduler.retryAfterSeconds()));
+    if (position > 0) {
+        res.set_header("X-Queue-Position", std::to_string(position));
+    }
+
+    json body = {
+        {"error", position > 0 ? "Transcode queued" : "Transcode server busy"},
+        {"queue_position", position}
+    };
+    res.set_content(body.dump(), "application/json");
+}
+
 // Profile structure
 struct Profile {
     std::string id;
@@ -167,6 +271,12 @@ struct Config {
     int port = 8080;
     std::string host = "0.0.0.0";
     std::vector<Profile> profiles;
+    TranscodeLimits transcoding;
+    unsigned scanThreads = 0;  // 0 = derive from core count
+    bool watchLibrary = true;  // Apply filesystem changes while running
+    int rescanInterval = 300;  // Seconds between directory mtime checks (0 = off)
+    std::string cacheDirectory;  // Transcode cache location (default: temp directory)
+    uint64_t cacheMaxMB = 10240; // Transcode cache budget
 
     static Config load(const std::string& configFile) {
         Config config;
@@ -193,6 +303,26 @@ struct Config {
             if (j.contains("host")) {
                 config.host = j["host"].get<std::string>();
             }
+            if (j.contains("scan_threads")) {
+                config.scanThreads = j["scan_threads"].get<unsigned>();
+            }
+            if (j.contains("watch_library")) {
+                config.watchLibrary = j["watch_library"].get<bool>();
+            }
+            if (j.contains("rescan_interval")) {
+                config.rescanInterval = j["rescan_interval"].get<int>();
+            }
+            if (j.contains("transcoding") && j["transcoding"].is_object()) {
+                auto& t = j["transcoding"];
+                config.transcoding.maxConcurrent = t.value("max_concurrent", config.transcoding.maxConcurrent);
+                config.transcoding.maxQueued = t.value("max_queued", config.transcoding.maxQueued);
+                config.transcoding.threadsPerJob = t.value("ffmpeg_threads", config.transcoding.threadsPerJob);
+            }
+            if (j.contains("transcode_cache") && j["transcode_cache"].is_object()) {
+                auto& c = j["transcode_cache"];
+                config.cacheDirectory = c.value("directory", config.cacheDirectory);
+                config.cacheMaxMB = c.value("max_size_mb", config.cacheMaxMB);
+            }
             if (j.contains("profiles") && j["profiles"].is_array()) {
                 auto profilesArray = j["profiles"];
                 // Limit to max 5 profiles
@@ -250,32 +380,56 @@ int main(int argc, char** argv) {
 
     std::cout << "Starting Simple Media Server..." << std::endl;
     std::cout << "Library path: " << libPath << std::endl;
-    std::cout << "Scanning library..." << std::endl;
 
-    // Scan library
     VideoScanner scanner(libPath.string());
-    MediaLibrary library = scanner.scan();
+    scanner.setThreads(config.scanThreads);
+
+    // Start from the saved index when there is one and only re-read the
+    // directories that changed since; otherwise do a full scan
+    std::string indexFile = (fs::temp_directory_path() / "media_server_library.idx").string();
+    auto directories = LibraryIndex::load(indexFile, libPath.string());
+    bool fromIndex = directories.has_value();
+    if (!fromIndex) {
+        std::cout << "Scanning library..." << std::endl;
+        directories = scanner.scanTree();
+        LibraryIndex::save(indexFile, libPath.string(), *directories);
+    }
 
-    std::cout << "Found " << library.series.size() << " series and "
-              << library.movies.size() << " movies" << std::endl;
+    LibraryWatcher libraryWatcher(scanner, std::move(*directories));
+    libraryWatcher.setUpdateHandler([indexFile, root = libPath.string()](const auto& dirs) {
+        LibraryIndex::save(indexFile, root, dirs);
+    });
 
-    // Create HLS cache
-    HLSCache hlsCache;
+    auto library = libraryWatcher.library();
+    std::cout << "Found " << library->series.size() << " series and "
+              << library->movies.size() << " movies" << std::endl;
 
-    // Create HLS cache directory
-    fs::path hlsCacheDir = fs::temp_directory_path() / "media_server_hls";
-    if (!fs::exists(hlsCacheDir)) {
-        fs::create_directories(hlsCacheDir);
+    // Pick up added/removed/renamed files without a restart. With an index
+    // the watcher reconciles in the background while requests are served.
+    if (config.watchLibrary) {
+        libraryWatcher.start(std::chrono::seconds(config.rescanInterval), fromIndex);
+    } else if (fromIndex) {
+        libraryWatcher.reconcile();
     }
 
-    // Create legacy video cache
-    LegacyCache legacyCache;
+    // Keep ffprobe results across restarts
+    VideoInfoAnalyzer::enableCache((fs::temp_directory_path() / "media_server_probe_cache.json").string());
 
-    // Create legacy video cache directory
-    fs::path legacyCacheDir = fs::temp_directory_path() / "media_server_legacy";
-    if (!fs::exists(legacyCacheDir)) {
-        fs::create_directories(legacyCacheDir);
-    }
+    // Size-bounded store for HLS renditions and legacy MP4s; declared before
+    // the scheduler so it outlives jobs that publish into it
+    fs::path cacheDir = config.cacheDirectory.empty()
+        ? fs::temp_directory_path() / "media_server_cache"
+        : fs::path(config.cacheDirectory);
+    TranscodeCache transcodeCache(cacheDir, config.cacheMaxMB * 1024 * 1024);
+
+    // Bounded pool that runs every ffmpeg transcode
+    TranscodeScheduler scheduler(config.transcoding);
+
+    // Create HLS transcode job registry
+    TranscodeJobRegistry hlsJobs;
+
+    // Create legacy transcode job registry
+    TranscodeJobRegistry legacyJobs;
 
     // Create HTTP server
     httplib::Server server;
@@ -306,9 +460,24 @@ int main(int argc, char** argv) {
     });
 
     // API endpoint: Get library structure
-    server.Get("/api/library", [&library](const httplib::Request&, httplib::Response& res) {
-        json response = library.toJson();
-        res.set_content(response.dump(), "application/json");
+    // The library JSON is serialized (and compressed) once per library
+    // snapshot; refreshes are answered from the cached body or with a 304
+    std::mutex libraryResponseMutex;
+    std::shared_ptr<const MediaLibrary> libraryResponseSource;
+    std::shared_ptr<const CachedResponse> libraryResponse;
+
+    server.Get("/api/library", [&](const httplib::Request& req, httplib::Response& res) {
+        std::shared_ptr<const CachedResponse> response;
+        {
+            std::lock_guard<std::mutex> lock(libraryResponseMutex);
+            auto library = libraryWatcher.library();
+            if (library != libraryResponseSource) {
+                libraryResponse = CachedResponse::build(library->toJson().dump(), "application/json");
+                libraryResponseSource = library;
+            }
+            response = libraryResponse;
+        }
+        response->serve(req, res);
     });
 
     // API endpoint: Get video codec/format information
@@ -372,6 +541,13 @@ int main(int argc, char** argv) {
         std::cout << "[API] ================================\n" << std::endl;
     });
 
+    // API endpoint: Running and queued transcodes
+    server.Get("/api/transcodes", [&scheduler, &transcodeCache](const httplib::Request&, httplib::Response& res) {
+        json response = scheduler.toJson();
+        response["cache"] = transcodeCache.toJson();
+        res.set_content(response.dump(), "application/json");
+    });
+
     // Serve video files with range request support
     server.Get("/video/.*", [&libPath](const httplib::Request& req, httplib::Response& res) {
         // Extract video path from URL
@@ -410,78 +586,16 @@ int main(int argc, char** argv) {
         else if (ext == ".3gp") contentType = "video/3gpp";
         else if (ext == ".ogv") contentType = "video/ogg";
 
-        // Serve file with range request support (enables seeking)
-        std::ifstream file(fullPath, std::ios::binary);
-        if (!file) {
+        // Stream file with range request support (enables seeking)
+        if (!FileStreamer::serve(req, res, fullPath.string(), contentType)) {
             res.status = 500;
             res.set_content("Error reading file", "text/plain");
             return;
         }
-
-        // Get file size
-        file.seekg(0, std::ios::end);
-        size_t fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        // Check for Range header
-        auto rangeHeader = req.get_header_value("Range");
-
-        if (!rangeHeader.empty()) {
-            // Parse range header (format: bytes=start-end)
-            size_t start = 0, end = fileSize - 1;
-
-            std::string rangeStr = rangeHeader;
-            size_t pos = rangeStr.find("bytes=");
-            if (pos != std::string::npos) {
-                rangeStr = rangeStr.substr(pos + 6);
-                size_t dashPos = rangeStr.find('-');
-
-                if (dashPos != std::string::npos) {
-                    std::string startStr = rangeStr.substr(0, dashPos);
-                    std::string endStr = rangeStr.substr(dashPos + 1);
-
-                    if (!startStr.empty()) start = std::stoull(startStr);
-                    if (!endStr.empty()) end = std::stoull(endStr);
-                }
-            }
-
-            // Validate range
-            if (start >= fileSize) {
-                res.status = 416; // Range Not Satisfiable
-                return;
-            }
-            if (end >= fileSize) end = fileSize - 1;
-
-            size_t contentLength = end - start + 1;
-
-            // Set partial content response
-            res.status = 206;
-            res.set_header("Content-Range",
-                "bytes " + std::to_string(start) + "-" +
-                std::to_string(end) + "/" + std::to_string(fileSize));
-            res.set_header("Content-Length", std::to_string(contentLength));
-            res.set_header("Accept-Ranges", "bytes");
-            res.set_header("Content-Type", contentType);
-
-            // Read and send requested range
-            file.seekg(start);
-            std::vector<char> buffer(contentLength);
-            file.read(buffer.data(), contentLength);
-            res.set_content(buffer.data(), contentLength, contentType);
-
-        } else {
-            // Send entire file
-            res.set_header("Accept-Ranges", "bytes");
-            res.set_header("Content-Length", std::to_string(fileSize));
-
-            std::vector<char> buffer(fileSize);
-            file.read(buffer.data(), fileSize);
-            res.set_content(buffer.data(), fileSize, contentType);
-        }
     });
 
     // HLS playlist endpoint with smart transcoding
-    server.Get(R"(/hls/(.+)/playlist\.m3u8)", [&libPath, &hlsCache, &hlsCacheDir](const httplib::Request& req, httplib::Response& res) {
+    server.Get(R"(/hls/(.+)/playlist\.m3u8)", [&libPath, &hlsJobs, &transcodeCache, &scheduler](const httplib::Request& req, httplib::Response& res) {
         std::cout << "\n[HLS] ===== HLS Playlist Request =====" << std::endl;
         std::string videoPath = httplib::detail::decode_url(req.matches[1].str(), false);
         std::cout << "[HLS] Video path: " << videoPath << std::endl;
@@ -504,78 +618,96 @@ int main(int argc, char** argv) {
             return;
         }
 
-        // Check cache first
-        std::lock_guard<std::mutex> lock(hlsCache.mutex);
+        // Requests for the same title share one job; other titles are never blocked
+        bool created = false;
+        auto job = hlsJobs.acquire(videoPath, created);
 
-        if (hlsCache.playlists.find(videoPath) == hlsCache.playlists.end()) {
-            std::cout << "[HLS] Not in cache, generating HLS stream..." << std::endl;
-
-            // Analyze video to determine smart transcoding strategy
-            auto videoInfo = VideoInfoAnalyzer::analyze(fullPath.string());
-
-            bool copyVideo = false;
-            bool copyAudio = false;
-            int audioStreamIndex = -1;
-            int subtitleStreamIndex = -1;
-
-            if (videoInfo) {
-                // Selective stream copy for ZERO quality degradation
-                copyVideo = !videoInfo->needs_video_transcode;
-                copyAudio = !videoInfo->needs_audio_transcode;
-
-                std::cout << "[HLS] Smart transcoding strategy:" << std::endl;
-                std::cout << "[HLS]   Video: " << (copyVideo ? "✓ COPY (zero quality loss)" : "✗ Transcode to H.264") << std::endl;
-                std::cout << "[HLS]   Audio: " << (copyAudio ? "✓ COPY (zero quality loss)" : "✗ Transcode to AAC") << std::endl;
-
-                // Find English audio stream (prioritize English over other languages)
-                for (size_t i = 0; i < videoInfo->audio_streams.size(); i++) {
-                    // Check stream metadata for language (this would need to be added to VideoCodecInfo)
-                    // For now, prefer stream 1 (often English in multi-audio files) if there are multiple streams
-                    if (videoInfo->audio_streams.size() > 1 && i == 1) {
-                        audioStreamIndex = i;
-                        std::cout << "[HLS]   Selected audio stream: " << i << " (likely English)" << std::endl;
-                        break;
-                    }
-                }
+        if (created) {
+            std::string cacheKey = TranscodeCache::key(fullPath, kHLSCacheParameters);
+            if (cacheKey.empty()) {
+                job->setState(JobState::Failed);
+                res.status = 404;
+                res.set_content("Video not found", "text/plain");
+                return;
+            }
+            auto cached = transcodeCache.lookup(cacheKey);
 
-                // Find English subtitle stream if available
-                // (Subtitle selection logic would go here if we add subtitle metadata)
+            if (cached) {
+                std::cout << "[HLS] Serving cached stream" << std::endl;
+                job->setOutput(*cached);
+                job->setState(JobState::Ready);
             } else {
-                std::cerr << "[HLS] WARNING: Could not analyze video, using full transcode" << std::endl;
+                std::cout << "[HLS] Not in cache, generating HLS stream..." << std::endl;
+                fs::path stagingDir = transcodeCache.stagingPath(cacheKey);
+                job->setOutput(stagingDir);
+
+                // Segments are served from the staging directory while ffmpeg
+                // runs; the finished stream is moved into the cache
+                bool queued = scheduler.submit(job, TranscodePriority::Interactive,
+                    [job, fullPath, cacheKey, stagingDir, &transcodeCache](int threads) {
+                        if (!runHLSJob(job, fullPath, threads)) {
+                            std::error_code ec;
+                            fs::remove_all(stagingDir, ec);
+                            return false;
+                        }
+                        auto published = transcodeCache.publish(cacheKey, "");
+                        if (!published) return false;
+                        job->setOutput(*published);
+                        return true;
+                    });
+                if (!queued) {
+                    job->setState(JobState::Failed);
+                    respondTranscodeBusy(res, scheduler, videoPath);
+                    return;
+                }
             }
+        } else {
+            std::cout << "[HLS] Joining existing job (" << jobStateName(job->state()) << ")" << std::endl;
+        }
 
-            // Generate HLS segments
-            fs::path segmentDir = hlsCacheDir / std::to_string(std::hash<std::string>{}(videoPath));
-            std::string playlistContent;
+        // Don't hold the connection while the job waits for a free worker
+        if (job->waitUntilStarted(kQueuedJobWait) == JobState::Pending) {
+            std::cout << "[HLS] Job queued at position " << scheduler.queuePosition(videoPath) << std::endl;
+            respondTranscodeBusy(res, scheduler, videoPath);
+            return;
+        }
 
-            std::cout << "[HLS] Starting HLS generation..." << std::endl;
-            if (!generateHLS(fullPath, segmentDir, playlistContent, copyVideo, copyAudio, audioStreamIndex, subtitleStreamIndex)) {
+        // Wait until ffmpeg has written the first segment
+        std::string playlistContent;
+        auto deadline = std::chrono::steady_clock::now() + kHLSFirstSegmentTimeout;
+        while ((playlistContent = readProgressivePlaylist(job->output())).empty()) {
+            JobState state = job->state();
+            if (state == JobState::Ready || state == JobState::Failed) {
                 std::cerr << "[HLS] ERROR: Failed to generate HLS stream" << std::endl;
                 res.status = 500;
                 res.set_content("Failed to generate HLS stream", "text/plain");
                 return;
             }
 
-            std::cout << "[HLS] HLS generation complete!" << std::endl;
+            if (std::chrono::steady_clock::now() >= deadline) {
+                std::cerr << "[HLS] WARNING: No segment produced yet, asking client to retry" << std::endl;
+                res.status = 503;
+                res.set_header("Retry-After", "2");
+                res.set_content("HLS stream is still starting", "text/plain");
+                return;
+            }
 
-            // Cache the playlist and segment directory
-            hlsCache.playlists[videoPath] = playlistContent;
-            hlsCache.segmentDirs[videoPath] = segmentDir;
-        } else {
-            std::cout << "[HLS] Serving from cache" << std::endl;
+            std::this_thread::sleep_for(kHLSPollInterval);
         }
 
-        // Serve cached playlist
+        transcodeCache.touch(job->output());
+
+        // Serve current playlist; clients reload it until #EXT-X-ENDLIST appears
         res.set_header("Content-Type", "application/vnd.apple.mpegurl");
         res.set_header("Cache-Control", "no-cache");
-        res.set_content(hlsCache.playlists[videoPath], "application/vnd.apple.mpegurl");
+        res.set_content(playlistContent, "application/vnd.apple.mpegurl");
 
         std::cout << "[HLS] Playlist served successfully" << std::endl;
         std::cout << "[HLS] ================================\n" << std::endl;
     });
 
     // HLS segment endpoint
-    server.Get(R"(/hls/(.+)/(segment\d+\.ts))", [&hlsCache](const httplib::Request& req, httplib::Response& res) {
+    server.Get(R"(/hls/(.+)/(segment\d+\.ts))", [&hlsJobs, &transcodeCache](const httplib::Request& req, httplib::Response& res) {
         std::string videoPath = httplib::detail::decode_url(req.matches[1].str(), false);
         std::string segmentName = req.matches[2].str();
 
@@ -586,16 +718,33 @@ int main(int argc, char** argv) {
             return;
         }
 
-        std::lock_guard<std::mutex> lock(hlsCache.mutex);
-
         // Check if we have segments for this video
-        if (hlsCache.segmentDirs.find(videoPath) == hlsCache.segmentDirs.end()) {
+        auto job = hlsJobs.find(videoPath);
+        if (!job) {
             res.status = 404;
             res.set_content("Segments not found", "text/plain");
             return;
         }
 
-        fs::path segmentPath = hlsCache.segmentDirs[videoPath] / segmentName;
+        // The segment may still be encoding; wait briefly while ffmpeg runs.
+        // The output moves from staging into the cache when the job finishes,
+        // so the path is re-read on every check.
+        fs::path segmentPath;
+        auto deadline = std::chrono::steady_clock::now() + kHLSSegmentTimeout;
+        while (true) {
+            JobState state = job->state();
+            segmentPath = job->output() / segmentName;
+            if (fs::exists(segmentPath)) {
+                break;
+            }
+            bool generating = state == JobState::Pending || state == JobState::Running;
+            if (!generating || std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+            std::this_thread::sleep_for(kHLSPollInterval);
+        }
+
+        transcodeCache.touch(job->output());
 
         if (!fs::exists(segmentPath) || !fs::is_regular_file(segmentPath)) {
             res.status = 404;
@@ -624,7 +773,7 @@ int main(int argc, char** argv) {
     });
 
     // Legacy-compatible video endpoint (H.264 Baseline + AAC MP4)
-    server.Get("/legacy/.*", [&libPath, &legacyCache, &legacyCacheDir](const httplib::Request& req, httplib::Response& res) {
+    server.Get("/legacy/.*", [&libPath, &legacyJobs, &transcodeCache, &scheduler](const httplib::Request& req, httplib::Response& res) {
         // Extract video path from URL
         std::string videoPath = req.path.substr(8); // Remove "/legacy/"
 
@@ -646,34 +795,74 @@ int main(int argc, char** argv) {
             return;
         }
 
-        // Check cache first
-        std::lock_guard<std::mutex> lock(legacyCache.mutex);
+        // Requests for the same title share one job; the creator does the work
+        bool created = false;
+        auto job = legacyJobs.acquire(videoPath, created);
 
-        if (legacyCache.legacyFiles.find(videoPath) == legacyCache.legacyFiles.end()) {
+        if (created) {
             // Check if video is already legacy-compatible
             auto videoInfo = VideoInfoAnalyzer::analyze(fullPath.string());
 
             if (videoInfo && videoInfo->is_legacy_compatible) {
                 // Video is already compatible, serve original
                 std::cout << "Video is already legacy-compatible, serving original" << std::endl;
-                legacyCache.legacyFiles[videoPath] = fullPath;
+                job->setOutput(fullPath);
+                job->setState(JobState::Ready);
             } else {
                 // Generate legacy-compatible MP4
-                fs::path legacyFile = legacyCacheDir / (std::to_string(std::hash<std::string>{}(videoPath)) + ".mp4");
-
-                if (!fs::exists(legacyFile)) {
-                    if (!generateLegacyMP4(fullPath, legacyFile)) {
-                        res.status = 500;
-                        res.set_content("Failed to generate legacy-compatible video", "text/plain");
+                std::string cacheKey = TranscodeCache::key(fullPath, kLegacyCacheParameters);
+                if (cacheKey.empty()) {
+                    job->setState(JobState::Failed);
+                    res.status = 404;
+                    res.set_content("Video not found", "text/plain");
+                    return;
+                }
+                auto cached = transcodeCache.lookup(cacheKey);
+
+                if (cached) {
+                    job->setOutput(*cached);
+                    job->setState(JobState::Ready);
+                } else {
+                    fs::path stagingFile = transcodeCache.stagingPath(cacheKey);
+                    job->setOutput(stagingFile);
+
+                    // Whole-file conversion is batch work; HLS playback goes first
+                    bool queued = scheduler.submit(job, TranscodePriority::Background,
+                        [job, fullPath, cacheKey, stagingFile, &transcodeCache](int threads) {
+                            if (!generateLegacyMP4(fullPath, stagingFile, threads)) {
+                                std::error_code ec;
+                                fs::remove(stagingFile, ec);
+                                return false;
+                            }
+                            auto published = transcodeCache.publish(cacheKey, ".mp4");
+                            if (!published) return false;
+                            job->setOutput(*published);
+                            return true;
+                        });
+                    if (!queued) {
+                        job->setState(JobState::Failed);
+                        respondTranscodeBusy(res, scheduler, videoPath);
                         return;
                     }
                 }
-
-                legacyCache.legacyFiles[videoPath] = legacyFile;
             }
         }
 
-        fs::path legacyFilePath = legacyCache.legacyFiles[videoPath];
+        // Don't hold the connection while the job waits for a free worker
+        if (job->waitUntilStarted(kQueuedJobWait) == JobState::Pending) {
+            respondTranscodeBusy(res, scheduler, videoPath);
+            return;
+        }
+
+        JobState state = job->waitUntilFinished(kLegacyTranscodeTimeout);
+        if (state != JobState::Ready) {
+            res.status = 500;
+            res.set_content("Failed to generate legacy-compatible video", "text/plain");
+            return;
+        }
+
+        fs::path legacyFilePath = job->output();
+        transcodeCache.touch(legacyFilePath);
 
         // Serve the legacy file with range request support
         std::ifstream file(legacyFilePath, std::ios::binary);
@@ -0,0 +1,134 @@
+#include "probe_cache.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+// Pending entries are written back at most this often
+static const auto kFlushInterval = std::chrono::seconds(5);
+
+std::optional<FileStamp> FileStamp::of(const std::string& path) {
+    std::error_code ec;
+    auto size = fs::file_size(path, ec);
+    if (ec) return std::nullopt;
+    auto mtime = fs::last_write_time(path, ec);
+    if (ec) return std::nullopt;
+
+    FileStamp stamp;
+    stamp.size = static_cast<int64_t>(size);
+    stamp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return stamp;
+}
+
+ProbeCache::~ProbeCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+    flush();
+}
+
+void ProbeCache::open(const std::string& cacheFile) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cacheFile_ = cacheFile;
+
+    std::ifstream file(cacheFile);
+    if (file) {
+        try {
+            json j;
+            file >> j;
+            json entries = j.value("entries", json::object());
+            for (const auto& [path, e] : entries.items()) {
+                Entry entry;
+                entry.stamp.size = e.value("size", int64_t(0));
+                entry.stamp.mtime = e.value("mtime", int64_t(0));
+                entry.output = e.value("output", "");
+                entries_[path] = std::move(entry);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[ProbeCache] Ignoring unreadable cache file: " << e.what() << std::endl;
+            entries_.clear();
+        }
+    }
+
+    std::cout << "[ProbeCache] Loaded " << entries_.size() << " entries from " << cacheFile << std::endl;
+
+    if (!flusher_.joinable()) {
+        flusher_ = std::thread(&ProbeCache::flushLoop, this);
+    }
+}
+
+std::optional<std::string> ProbeCache::get(const std::string& path, const FileStamp& stamp) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(path);
+    if (it == entries_.end() || !(it->second.stamp == stamp)) {
+        return std::nullopt;
+    }
+    return it->second.output;
+}
+
+void ProbeCache::put(const std::string& path, const FileStamp& stamp, const std::string& output) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_[path] = Entry{stamp, output};
+    dirty_ = true;
+}
+
+void ProbeCache::flush() {
+    std::lock_guard<std::mutex> writeLock(writeMutex_);
+
+    json j;
+    std::string cacheFile;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!dirty_ || cacheFile_.empty()) return;
+
+        j["version"] = 1;
+        j["entries"] = json::object();
+        for (const auto& [path, entry] : entries_) {
+            j["entries"][path] = {
+                {"size", entry.stamp.size},
+                {"mtime", entry.stamp.mtime},
+                {"output", entry.output}
+            };
+        }
+        cacheFile = cacheFile_;
+        dirty_ = false;
+    }
+
+    // Write to a temporary file and rename so a crash never leaves a torn cache
+    std::string tmpFile = cacheFile + ".tmp";
+    {
+        std::ofstream out(tmpFile, std::ios::trunc);
+        if (!out) {
+            std::cerr << "[ProbeCache] Cannot write " << tmpFile << std::endl;
+            return;
+        }
+        out << j.dump();
+    }
+
+    std::error_code ec;
+    fs::rename(tmpFile, cacheFile, ec);
+    if (ec) {
+        std::cerr << "[ProbeCache] Cannot replace " << cacheFile << ": " << ec.message() << std::endl;
+    }
+}
+
+void ProbeCache::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        cv_.wait_for(lock, kFlushInterval, [this]() { return stopping_; });
+        if (stopping_ || !dirty_) continue;
+
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <optional>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+
+// Identity of a file's content as far as the cache is concerned.
+// Any change to size or modification time invalidates cached results.
+struct FileStamp {
+    int64_t size = 0;
+    int64_t mtime = 0;
+
+    bool operator==(const FileStamp& other) const {
+        return size == other.size && mtime == other.mtime;
+    }
+
+    // Stamp of a file on disk, or nullopt if it cannot be stat'ed
+    static std::optional<FileStamp> of(const std::string& path);
+};
+
+// Persistent cache of raw ffprobe output keyed by path + size + mtime.
+// Lookups are served from memory; the map is loaded from and written back
+// to a JSON file so probes survive restarts.
+class ProbeCache {
+public:
+    ProbeCache() = default;
+    ~ProbeCache();
+
+    ProbeCache(const ProbeCache&) = delete;
+    ProbeCache& operator=(const ProbeCache&) = delete;
+
+    // Load entries from the cache file and start writing changes back to it
+    void open(const std::string& cacheFile);
+
+    // Cached output for a file, only if it has not changed since probing
+    std::optional<std::string> get(const std::string& path, const FileStamp& stamp);
+
+    void put(const std::string& path, const FileStamp& stamp, const std::string& output);
+
+    // Write pending changes to disk now
+    void flush();
+
+private:
+    struct Entry {
+        FileStamp stamp;
+        std::string output;
+    };
+
+    void flushLoop();
+
+    std::mutex mutex_;
+    std::mutex writeMutex_;  // serializes writers of the cache file
+    std::condition_variable cv_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::string cacheFile_;
+    bool dirty_ = false;
+    bool stopping_ = false;
+    std::thread flusher_;
+};
@@ -0,0 +1,130 @@
+#include "process.h"
+#include <iostream>
+
+#ifndef _WIN32
+#include <spawn.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <cerrno>
+#include <cstring>
+
+extern char** environ;
+#endif
+
+#ifdef _WIN32
+// Quote one argument following the MSVC runtime's command line rules
+static std::string quoteArgument(const std::string& arg) {
+    if (!arg.empty() && arg.find_first_of(" \t\n\v\"") == std::string::npos) {
+        return arg;
+    }
+
+    std::string quoted = "\"";
+    size_t backslashes = 0;
+    for (char c : arg) {
+        if (c == '\\') {
+            backslashes++;
+        } else if (c == '"') {
+            quoted.append(backslashes * 2 + 1, '\\');
+            quoted += '"';
+            backslashes = 0;
+        } else {
+            quoted.append(backslashes, '\\');
+            quoted += c;
+            backslashes = 0;
+        }
+    }
+    quoted.append(backslashes * 2, '\\');
+    quoted += '"';
+    return quoted;
+}
+#endif
+
+std::unique_ptr<Process> Process::spawn(const std::vector<std::string>& args) {
+    if (args.empty()) return nullptr;
+
+    std::unique_ptr<Process> process(new Process());
+
+#ifdef _WIN32
+    std::string commandLine;
+    for (const auto& arg : args) {
+        if (!commandLine.empty()) commandLine += ' ';
+        commandLine += quoteArgument(arg);
+    }
+
+    STARTUPINFOA startup{};
+    startup.cb = sizeof(startup);
+    PROCESS_INFORMATION info{};
+    if (!CreateProcessA(nullptr, &commandLine[0], nullptr, nullptr, TRUE, 0,
+                        nullptr, nullptr, &startup, &info)) {
+        std::cerr << "[Process] Cannot start " << args[0] << ": error " << GetLastError() << std::endl;
+        return nullptr;
+    }
+    CloseHandle(info.hThread);
+    process->handle_ = info.hProcess;
+#else
+    std::vector<char*> argv;
+    for (const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    int err = posix_spawnp(&process->pid_, argv[0], nullptr, nullptr, argv.data(), environ);
+    if (err != 0) {
+        std::cerr << "[Process] Cannot start " << args[0] << ": " << std::strerror(err) << std::endl;
+        return nullptr;
+    }
+#endif
+
+    return process;
+}
+
+Process::~Process() {
+    // Never leave a running child or a zombie behind
+    kill();
+    wait();
+#ifdef _WIN32
+    if (handle_) CloseHandle(handle_);
+#endif
+}
+
+int Process::wait() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (exited_) return exitCode_;
+    }
+
+#ifdef _WIN32
+    WaitForSingleObject(handle_, INFINITE);
+    DWORD code = 0;
+    GetExitCodeProcess(handle_, &code);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    exitCode_ = static_cast<int>(code);
+    exited_ = true;
+#else
+    // Wait without reaping first, so kill() can never signal a recycled pid
+    siginfo_t info{};
+    while (waitid(P_PID, pid_, &info, WEXITED | WNOWAIT) < 0 && errno == EINTR) {
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    int status = 0;
+    while (waitpid(pid_, &status, 0) < 0 && errno == EINTR) {
+    }
+    exitCode_ = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    exited_ = true;
+#endif
+
+    return exitCode_;
+}
+
+void Process::kill() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (exited_) return;
+
+#ifdef _WIN32
+    TerminateProcess(handle_, 1);
+#else
+    ::kill(pid_, SIGKILL);
+#endif
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#endif
+
+// Child process started from an argument vector, without a shell.
+// Unlike std::system the caller gets a handle it can wait on or kill, which
+// is what lets a transcode be cancelled when the viewer seeks elsewhere.
+class Process {
+public:
+    // Start args[0] (looked up in PATH) with the given arguments.
+    // stdout/stderr are inherited; returns nullptr if the spawn failed.
+    static std::unique_ptr<Process> spawn(const std::vector<std::string>& args);
+
+    ~Process();
+
+    Process(const Process&) = delete;
+    Process& operator=(const Process&) = delete;
+
+    // Block until the process exits. Returns its exit code, or -1 if it was
+    // killed by a signal. Call from one thread only.
+    int wait();
+
+    // Terminate the process (safe to call from another thread, and after exit)
+    void kill();
+
+private:
+    Process() = default;
+
+    std::mutex mutex_;
+    bool exited_ = false;  // guarded by mutex_; the child has been reaped
+    int exitCode_ = -1;
+
+#ifdef _WIN32
+    HANDLE handle_ = nullptr;
+#else
+    pid_t pid_ = -1;
+#endif
+};
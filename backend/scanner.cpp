@@ -1,8 +1,12 @@
 #include "scanner.h"
 #include <filesystem>
-#include <regex>
 #include <algorithm>
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 namespace fs = std::filesystem;
 
@@ -29,32 +33,187 @@ bool VideoScanner::isVideoFile(const std::string& filename) {
     return false;
 }
 
+// Hand-written matchers for the filename patterns below. Each one behaves
+// exactly like the std::regex it replaces (leftmost match, greedy counts with
+// the same backtracking outcome) without building a regex per call.
+namespace {
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Same character set as \s in the "C" locale
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// Characters collapsed into a single space by the name cleaners
+bool isSeparator(char c) {
+    return c == '.' || c == '_' || c == '-' || isSpace(c);
+}
+
+char toLowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Number of consecutive digits at pos, capped at max
+size_t digitRun(const std::string& s, size_t pos, size_t max) {
+    size_t n = 0;
+    while (n < max && pos + n < s.size() && isDigit(s[pos + n])) n++;
+    return n;
+}
+
+// Case-insensitive comparison of a lowercase word at pos
+bool matchWord(const std::string& s, size_t pos, const char* word) {
+    for (size_t i = 0; word[i] != '\0'; i++) {
+        if (pos + i >= s.size() || toLowerAscii(s[pos + i]) != word[i]) return false;
+    }
+    return true;
+}
+
+int toInt(const std::string& s, size_t pos, size_t len) {
+    int value = 0;
+    for (size_t i = 0; i < len; i++) value = value * 10 + (s[pos + i] - '0');
+    return value;
+}
+
+size_t skipSpaces(const std::string& s, size_t pos) {
+    while (pos < s.size() && isSpace(s[pos])) pos++;
+    return pos;
+}
+
+// Season/episode marker found in a filename, covering [begin, end)
+struct EpisodeMarker {
+    size_t begin;
+    size_t end;
+    int season;
+    int episode;
+};
+
+// [Ss](\d{1,2})[Ee](\d{1,3})  e.g. S01E01, s1e1
+std::optional<EpisodeMarker> matchSeasonEpisode(const std::string& s, size_t i) {
+    if (s[i] != 'S' && s[i] != 's') return std::nullopt;
+    size_t seasonDigits = digitRun(s, i + 1, 2);
+    size_t e = i + 1 + seasonDigits;
+    if (seasonDigits == 0 || e >= s.size() || (s[e] != 'E' && s[e] != 'e')) return std::nullopt;
+    size_t episodeDigits = digitRun(s, e + 1, 3);
+    if (episodeDigits == 0) return std::nullopt;
+    return EpisodeMarker{i, e + 1 + episodeDigits, toInt(s, i + 1, seasonDigits), toInt(s, e + 1, episodeDigits)};
+}
+
+// (\d{1,2})x(\d{1,3})  e.g. 1x01
+std::optional<EpisodeMarker> matchCross(const std::string& s, size_t i) {
+    size_t seasonDigits = digitRun(s, i, 2);
+    size_t x = i + seasonDigits;
+    if (seasonDigits == 0 || x >= s.size() || s[x] != 'x') return std::nullopt;
+    size_t episodeDigits = digitRun(s, x + 1, 3);
+    if (episodeDigits == 0) return std::nullopt;
+    return EpisodeMarker{i, x + 1 + episodeDigits, toInt(s, i, seasonDigits), toInt(s, x + 1, episodeDigits)};
+}
+
+// [Ss]eason\s*(\d{1,2}).*[Ee]pisode\s*(\d{1,3}), case-insensitive.
+// The greedy .* makes the LAST "episode N" on the line win.
+std::optional<EpisodeMarker> matchSeasonEpisodeWords(const std::string& s, size_t i) {
+    if (!matchWord(s, i, "season")) return std::nullopt;
+    size_t digits = skipSpaces(s, i + 6);
+    size_t seasonDigits = digitRun(s, digits, 2);
+    if (seasonDigits == 0) return std::nullopt;
+    size_t seasonEnd = digits + seasonDigits;
+
+    // '.' does not cross line terminators
+    size_t limit = s.find_first_of("\n\r", seasonEnd);
+    if (limit == std::string::npos) limit = s.size();
+
+    for (size_t p = limit + 1; p-- > seasonEnd;) {
+        if (!matchWord(s, p, "episode")) continue;
+        size_t episodePos = skipSpaces(s, p + 7);
+        size_t episodeDigits = digitRun(s, episodePos, 3);
+        if (episodeDigits == 0) continue;
+        return EpisodeMarker{i, episodePos + episodeDigits, toInt(s, digits, seasonDigits), toInt(s, episodePos, episodeDigits)};
+    }
+    return std::nullopt;
+}
+
+using MarkerMatcher = std::optional<EpisodeMarker> (*)(const std::string&, size_t);
+
+// Common patterns for TV shows, in priority order:
+// S01E01, S01E02, s01e01, S1E1, etc.
+// 1x01, 1x02, etc.
+// Season 1 Episode 1
+const MarkerMatcher kEpisodeMatchers[] = {
+    matchSeasonEpisode,
+    matchCross,
+    matchSeasonEpisodeWords,
+};
+
+// Leftmost marker at or after pos
+std::optional<EpisodeMarker> findMarker(MarkerMatcher matcher, const std::string& s, size_t pos) {
+    for (size_t i = pos; i < s.size(); i++) {
+        if (auto marker = matcher(s, i)) return marker;
+    }
+    return std::nullopt;
+}
+
+// Remove every non-overlapping marker, like regex_replace(s, pattern, "")
+std::string removeMarkers(MarkerMatcher matcher, const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    size_t pos = 0;
+    while (auto marker = findMarker(matcher, s, pos)) {
+        out.append(s, pos, marker->begin - pos);
+        pos = marker->end;
+    }
+    out.append(s, pos, std::string::npos);
+    return out;
+}
+
+// \s*[\(\[]?\d{4}[\)\]]?\s*  e.g. " (2020) ", "[2020]", "2020"
+std::optional<size_t> matchYear(const std::string& s, size_t i) {
+    size_t pos = skipSpaces(s, i);
+    if (pos < s.size() && (s[pos] == '(' || s[pos] == '[')) pos++;
+    if (digitRun(s, pos, 4) != 4) return std::nullopt;
+    pos += 4;
+    if (pos < s.size() && (s[pos] == ')' || s[pos] == ']')) pos++;
+    return skipSpaces(s, pos);
+}
+
+// Collapse runs of [._-] and whitespace into single spaces and trim
+std::string collapseSeparators(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    bool pendingSpace = false;
+    for (char c : s) {
+        if (isSeparator(c)) {
+            pendingSpace = true;
+            continue;
+        }
+        if (pendingSpace && !out.empty()) out += ' ';
+        pendingSpace = false;
+        out += c;
+    }
+    return out;
+}
+
+// Season folder such as "S01", "Season 1" ([Ss]eason\s*\d+|[Ss]\d+, case-insensitive)
+bool isSeasonFolderName(const std::string& name) {
+    for (size_t i = 0; i < name.size(); i++) {
+        if (toLowerAscii(name[i]) != 's') continue;
+        if (i + 1 < name.size() && isDigit(name[i + 1])) return true;
+        if (matchWord(name, i, "season") && digitRun(name, skipSpaces(name, i + 6), 1) == 1) return true;
+    }
+    return false;
+}
+
+} // namespace
+
 VideoScanner::ParsedInfo VideoScanner::parseFilename(const std::string& filename) {
     ParsedInfo info;
 
-    // Common patterns for TV shows:
-    // S01E01, S01E02, s01e01, S1E1, etc.
-    // 1x01, 1x02, etc.
-    // [01x01], (S01E01), etc.
-
-    std::vector<std::regex> patterns = {
-        // S01E01 or s01e01
-        std::regex(R"([Ss](\d{1,2})[Ee](\d{1,3}))"),
-        // 1x01
-        std::regex(R"((\d{1,2})x(\d{1,3}))"),
-        // Season 1 Episode 1
-        std::regex(R"([Ss]eason\s*(\d{1,2}).*[Ee]pisode\s*(\d{1,3}))", std::regex::icase),
-    };
-
-    for (const auto& pattern : patterns) {
-        std::smatch match;
-        std::string str = filename;
-        if (std::regex_search(str, match, pattern)) {
-            if (match.size() >= 3) {
-                info.season = std::stoi(match[1].str());
-                info.episode = std::stoi(match[2].str());
-                break;
-            }
+    for (MarkerMatcher matcher : kEpisodeMatchers) {
+        if (auto marker = findMarker(matcher, filename, 0)) {
+            info.season = marker->season;
+            info.episode = marker->episode;
+            break;
         }
     }
 
@@ -66,93 +225,266 @@ VideoScanner::ParsedInfo VideoScanner::parseFilename(const std::string& filename
     }
 
     // Remove season/episode patterns
-    for (const auto& pattern : patterns) {
-        cleanName = std::regex_replace(cleanName, pattern, "");
+    for (MarkerMatcher matcher : kEpisodeMatchers) {
+        cleanName = removeMarkers(matcher, cleanName);
     }
 
-    // Clean up extra characters
-    cleanName = std::regex_replace(cleanName, std::regex(R"([\._\-]+)"), " ");
-    cleanName = std::regex_replace(cleanName, std::regex(R"(\s+)"), " ");
-
-    // Trim
-    cleanName.erase(0, cleanName.find_first_not_of(" \t\r\n"));
-    cleanName.erase(cleanName.find_last_not_of(" \t\r\n") + 1);
-
-    info.cleanName = cleanName;
+    // Clean up extra characters and trim
+    info.cleanName = collapseSeparators(cleanName);
     return info;
 }
 
 std::string VideoScanner::cleanSeriesName(const std::string& dirname) {
-    std::string name = dirname;
+    // Replace year info like (2020), [2020] with a space
+    std::string name;
+    name.reserve(dirname.size());
+    size_t pos = 0;
+    for (size_t i = 0; i < dirname.size(); ) {
+        if (auto end = matchYear(dirname, i)) {
+            name.append(dirname, pos, i - pos);
+            name += ' ';
+            pos = i = *end;
+        } else {
+            i++;
+        }
+    }
+    name.append(dirname, pos, std::string::npos);
+
+    // Clean up extra characters and trim
+    return collapseSeparators(name);
+}
+
+void VideoScanner::setThreads(unsigned threads) {
+    if (threads == 0) {
+        // Directory reads are I/O bound (especially on network storage), so
+        // keep more requests in flight than there are cores
+        threads = std::max(4u, 2 * std::thread::hardware_concurrency());
+    }
+    threads_ = threads;
+}
+
+std::string VideoScanner::seriesNameForDirectory(const fs::path& dir) {
+    // Check if directory is a season folder (e.g., "S01", "Season 1")
+    std::string dirName = dir.filename().string();
+
+    std::string seriesName;
+    if (isSeasonFolderName(dirName)) {
+        // Season folder, use its parent as series name
+        seriesName = dir.parent_path().filename().string();
+    } else {
+        // Use directory as series name
+        seriesName = dirName;
+    }
 
-    // Remove common patterns like (2020), [2020], year info, etc.
-    name = std::regex_replace(name, std::regex(R"(\s*[\(\[]?\d{4}[\)\]]?\s*)"), " ");
-    name = std::regex_replace(name, std::regex(R"([\._\-]+)"), " ");
-    name = std::regex_replace(name, std::regex(R"(\s+)"), " ");
+    seriesName = cleanSeriesName(seriesName);
 
-    // Trim
-    name.erase(0, name.find_first_not_of(" \t\r\n"));
-    name.erase(name.find_last_not_of(" \t\r\n") + 1);
+    if (seriesName.empty()) {
+        seriesName = "Unknown Series";
+    }
 
-    return name;
+    return seriesName;
 }
 
-MediaLibrary VideoScanner::scan() {
-    MediaLibrary library;
+fs::path VideoScanner::absoluteDirectory(const std::string& relativeDir) const {
+    fs::path root(rootPath_);
+    if (!root.has_filename()) root = root.parent_path();  // strip trailing separator
+    return relativeDir.empty() ? root : root / relativeDir;
+}
 
-    if (!fs::exists(rootPath_) || !fs::is_directory(rootPath_)) {
-        std::cerr << "Error: Directory does not exist: " << rootPath_ << std::endl;
-        return library;
+std::optional<int64_t> VideoScanner::directoryMtime(const std::string& relativeDir) const {
+    std::error_code ec;
+    auto mtime = fs::last_write_time(absoluteDirectory(relativeDir), ec);
+    if (ec) return std::nullopt;
+    return static_cast<int64_t>(mtime.time_since_epoch().count());
+}
+
+ScannedDirectory VideoScanner::scanDirectory(const std::string& relativeDir) {
+    ScannedDirectory result;
+    result.path = relativeDir;
+
+    fs::path dir = absoluteDirectory(relativeDir);
+    fs::path root = absoluteDirectory("");
+
+    // Taken before listing, so a change made while reading shows up as a
+    // newer mtime on the next comparison
+    result.mtime = directoryMtime(relativeDir).value_or(0);
+
+    std::error_code ec;
+    fs::directory_iterator it(dir, ec);
+    if (ec) {
+        std::cerr << "Warning: Cannot read directory " << dir << ": " << ec.message() << std::endl;
+        return result;
     }
 
-    // Map to organize series: series_name -> season_number -> videos
-    std::map<std::string, std::map<int, std::vector<Video>>> seriesMap;
-    std::vector<Video> standaloneVideos;
+    std::optional<std::string> seriesName;  // computed on first episode
 
-    // Recursively scan directory
-    for (const auto& entry : fs::recursive_directory_iterator(rootPath_)) {
-        if (!entry.is_regular_file()) continue;
+    for (const auto& entry : it) {
+        // Same traversal rules as recursive_directory_iterator: don't follow
+        // directory symlinks, but accept symlinked files
+        if (entry.is_directory(ec) && !entry.is_symlink(ec)) {
+            result.subdirs.push_back(entry.path().lexically_relative(root).string());
+            continue;
+        }
+
+        if (!entry.is_regular_file(ec)) continue;
 
         std::string filename = entry.path().filename().string();
         if (!isVideoFile(filename)) continue;
 
-        std::string relativePath = fs::relative(entry.path(), rootPath_).string();
         ParsedInfo info = parseFilename(filename);
 
-        Video video;
-        video.path = relativePath;
-        video.filename = filename;
-        video.season = info.season;
-        video.episode = info.episode;
+        ScannedFile file;
+        file.video.path = entry.path().lexically_relative(root).string();
+        file.video.filename = filename;
+        file.video.season = info.season;
+        file.video.episode = info.episode;
 
         // If season/episode detected, it's a series
         if (info.season.has_value() && info.episode.has_value()) {
-            // Use parent directory as series name
-            std::string seriesName;
-            auto parentPath = entry.path().parent_path();
-
-            // Check if parent is a season folder (e.g., "S01", "Season 1")
-            std::string parentName = parentPath.filename().string();
-            std::regex seasonFolderPattern(R"([Ss]eason\s*(\d+)|[Ss](\d+))", std::regex::icase);
-
-            if (std::regex_search(parentName, seasonFolderPattern)) {
-                // Parent is season folder, use grandparent as series name
-                seriesName = parentPath.parent_path().filename().string();
-            } else {
-                // Use parent as series name
-                seriesName = parentName;
+            if (!seriesName) {
+                seriesName = seriesNameForDirectory(dir);
             }
+            file.seriesName = *seriesName;
+        } else {
+            // Standalone video (movie)
+            file.movieName = info.cleanName.empty() ? filename : info.cleanName;
+        }
 
-            seriesName = cleanSeriesName(seriesName);
+        result.files.push_back(std::move(file));
+    }
+
+    return result;
+}
 
-            if (seriesName.empty()) {
-                seriesName = "Unknown Series";
+std::vector<ScannedDirectory> VideoScanner::scanTree() {
+    unsigned threads = std::max(1u, threads_);
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Work-stealing traversal: every worker owns a deque of directories to
+    // read. A worker pops its newest directory (depth-first) and, when its
+    // own deque is empty, steals the oldest directory of another worker.
+    // Results are collected per worker and concatenated at the end.
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::string> pending;
+        std::vector<ScannedDirectory> results;
+    };
+
+    std::vector<Worker> workers(threads);
+    std::atomic<size_t> outstanding{1};  // directories queued or being read
+    workers[0].pending.push_back("");
+
+    auto run = [&](unsigned self) {
+        Worker& me = workers[self];
+
+        while (outstanding.load() > 0) {
+            std::optional<std::string> dir;
+            {
+                std::lock_guard<std::mutex> lock(me.mutex);
+                if (!me.pending.empty()) {
+                    dir = std::move(me.pending.back());
+                    me.pending.pop_back();
+                }
+            }
+
+            for (unsigned i = 1; !dir && i < threads; i++) {
+                Worker& victim = workers[(self + i) % threads];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.pending.empty()) {
+                    dir = std::move(victim.pending.front());
+                    victim.pending.pop_front();
+                }
+            }
+
+            if (!dir) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+
+            ScannedDirectory scanned = scanDirectory(*dir);
+            if (!scanned.subdirs.empty()) {
+                outstanding += scanned.subdirs.size();
+                std::lock_guard<std::mutex> lock(me.mutex);
+                me.pending.insert(me.pending.end(), scanned.subdirs.begin(), scanned.subdirs.end());
             }
+            me.results.push_back(std::move(scanned));
+            outstanding--;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; i++) {
+        pool.emplace_back(run, i);
+    }
+    run(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
 
-            seriesMap[seriesName][*info.season].push_back(video);
+    std::vector<ScannedDirectory> directories;
+    for (auto& worker : workers) {
+        std::move(worker.results.begin(), worker.results.end(), std::back_inserter(directories));
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime);
+    std::cout << "Scanned " << directories.size() << " directories in " << elapsed.count()
+              << "ms using " << threads << " thread(s)" << std::endl;
+
+    return directories;
+}
+
+MediaLibrary VideoScanner::scan() {
+    if (!fs::exists(rootPath_) || !fs::is_directory(rootPath_)) {
+        std::cerr << "Error: Directory does not exist: " << rootPath_ << std::endl;
+        return MediaLibrary();
+    }
+
+    return buildLibrary(scanTree());
+}
+
+MediaLibrary VideoScanner::buildLibrary(const std::vector<ScannedDirectory>& directories) {
+    std::vector<const ScannedFile*> files;
+    for (const auto& dir : directories) {
+        for (const auto& file : dir.files) {
+            files.push_back(&file);
+        }
+    }
+    return buildLibraryFromFiles(std::move(files));
+}
+
+MediaLibrary VideoScanner::buildLibrary(const std::map<std::string, ScannedDirectory>& directories) {
+    std::vector<const ScannedFile*> files;
+    for (const auto& [path, dir] : directories) {
+        for (const auto& file : dir.files) {
+            files.push_back(&file);
+        }
+    }
+    return buildLibraryFromFiles(std::move(files));
+}
+
+MediaLibrary VideoScanner::buildLibraryFromFiles(std::vector<const ScannedFile*> files) {
+    MediaLibrary library;
+
+    // Visit files in path order so the result never depends on the order
+    // in which directories were read
+    std::sort(files.begin(), files.end(),
+        [](const ScannedFile* a, const ScannedFile* b) {
+            return a->video.path < b->video.path;
+        });
+
+    // Map to organize series: series_name -> season_number -> videos
+    std::map<std::string, std::map<int, std::vector<Video>>> seriesMap;
+
+    for (const ScannedFile* file : files) {
+        if (!file->seriesName.empty()) {
+            seriesMap[file->seriesName][*file->video.season].push_back(file->video);
         } else {
             // Standalone video (movie)
-            standaloneVideos.push_back(video);
+            Movie movie;
+            movie.name = file->movieName;
+            movie.path = file->video.path;
+            library.movies.push_back(movie);
         }
     }
 
@@ -168,7 +500,7 @@ MediaLibrary VideoScanner::scan() {
             season.episodes = videos;
 
             // Sort episodes by episode number
-            std::sort(season.episodes.begin(), season.episodes.end(),
+            std::stable_sort(season.episodes.begin(), season.episodes.end(),
                 [](const Video& a, const Video& b) {
                     if (a.episode.has_value() && b.episode.has_value()) {
                         return *a.episode < *b.episode;
@@ -179,34 +511,14 @@ MediaLibrary VideoScanner::scan() {
             series.seasons.push_back(season);
         }
 
-        // Sort seasons
-        std::sort(series.seasons.begin(), series.seasons.end(),
-            [](const Season& a, const Season& b) {
-                return a.number < b.number;
-            });
-
+        // Seasons come out of the map already sorted by number
         library.series.push_back(series);
     }
 
-    // Sort series alphabetically
-    std::sort(library.series.begin(), library.series.end(),
-        [](const Series& a, const Series& b) {
-            return a.name < b.name;
-        });
-
-    // Convert standalone videos to movies
-    for (const auto& video : standaloneVideos) {
-        Movie movie;
-        movie.name = parseFilename(video.filename).cleanName;
-        if (movie.name.empty()) {
-            movie.name = video.filename;
-        }
-        movie.path = video.path;
-        library.movies.push_back(movie);
-    }
+    // Series come out of the map already sorted alphabetically
 
     // Sort movies alphabetically
-    std::sort(library.movies.begin(), library.movies.end(),
+    std::stable_sort(library.movies.begin(), library.movies.end(),
         [](const Movie& a, const Movie& b) {
             return a.name < b.name;
         });
@@ -4,6 +4,8 @@
 #include <vector>
 #include <map>
 #include <optional>
+#include <filesystem>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
@@ -43,6 +45,21 @@ struct MediaLibrary {
     json toJson() const;
 };
 
+// A video file found by the scanner, already classified
+struct ScannedFile {
+    Video video;
+    std::string seriesName;  // Cleaned series name (empty for movies)
+    std::string movieName;   // Cleaned movie name (empty for episodes)
+};
+
+// Contents of one directory as seen by the scanner (non-recursive)
+struct ScannedDirectory {
+    std::string path;                   // Relative to library root ("" for root)
+    std::vector<ScannedFile> files;     // Video files directly inside
+    std::vector<std::string> subdirs;   // Relative paths of child directories
+    int64_t mtime = 0;                  // Directory modification time when read
+};
+
 // Video scanner class
 class VideoScanner {
 public:
@@ -51,11 +68,38 @@ public:
     // Scan the library and organize content
     MediaLibrary scan();
 
+    // Number of threads used to walk the tree (1 = serial, 0 = auto).
+    // The resulting library is identical for every thread count.
+    void setThreads(unsigned threads);
+
+    // Walk the whole tree and return every directory that was read
+    std::vector<ScannedDirectory> scanTree();
+
+    // Read a single directory (relative to the root) without recursing
+    ScannedDirectory scanDirectory(const std::string& relativeDir);
+
+    // Absolute path of a directory relative to the root
+    std::filesystem::path absoluteDirectory(const std::string& relativeDir) const;
+
+    // Current modification time of a directory (relative to the root), or
+    // nullopt if it no longer exists
+    std::optional<int64_t> directoryMtime(const std::string& relativeDir) const;
+
+    // Organize scanned directories into series/seasons and movies
+    static MediaLibrary buildLibrary(const std::vector<ScannedDirectory>& directories);
+    static MediaLibrary buildLibrary(const std::map<std::string, ScannedDirectory>& directories);
+
     // Check if file is a video
     static bool isVideoFile(const std::string& filename);
 
 private:
     std::string rootPath_;
+    unsigned threads_ = 1;
+
+    static MediaLibrary buildLibraryFromFiles(std::vector<const ScannedFile*> files);
+
+    // Series name for episodes found in a directory
+    std::string seriesNameForDirectory(const std::filesystem::path& dir);
 
     // Pattern detection
     struct ParsedInfo {
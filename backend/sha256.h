@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+// Minimal SHA-256 (FIPS 180-4), used for stable cache keys
+class Sha256 {
+public:
+    // Lowercase hex digest of data
+    static std::string hex(const std::string& data);
+};
@@ -0,0 +1,272 @@
+#include "transcode_cache.h"
+#include "probe_cache.h"
+#include "sha256.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Access times from touch() reach the index at most this often
+static const auto kIndexSaveInterval = std::chrono::seconds(60);
+static const char* kIndexFile = "index.json";
+static const char* kStagingSuffix = ".partial";
+
+static int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Bytes used by a file or a directory tree
+static uint64_t diskUsage(const fs::path& path) {
+    std::error_code ec;
+    if (fs::is_regular_file(path, ec)) {
+        return fs::file_size(path, ec);
+    }
+
+    uint64_t total = 0;
+    for (fs::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code sizeEc;
+        if (it->is_regular_file(sizeEc)) {
+            auto size = it->file_size(sizeEc);
+            if (!sizeEc) total += size;
+        }
+    }
+    return total;
+}
+
+TranscodeCache::TranscodeCache(const fs::path& directory, uint64_t maxBytes)
+    : directory_(fs::absolute(directory)), maxBytes_(maxBytes) {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+
+    load();
+    removeOrphans();
+
+    std::vector<fs::path> victims;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        victims = evict("");
+    }
+    for (const auto& victim : victims) {
+        fs::remove_all(victim, ec);
+    }
+    saveIndex();
+
+    std::cout << "[Cache] " << entries_.size() << " cached renditions, "
+              << totalBytes_ / (1024 * 1024) << " of " << maxBytes_ / (1024 * 1024)
+              << " MB in " << directory_ << std::endl;
+}
+
+TranscodeCache::~TranscodeCache() {
+    saveIndex();
+}
+
+std::string TranscodeCache::key(const fs::path& source, const std::string& parameters) {
+    auto stamp = FileStamp::of(source.string());
+    if (!stamp) return "";
+
+    // NUL-separated so no two field combinations produce the same input
+    std::string input = source.string();
+    input += '\0';
+    input += std::to_string(stamp->size);
+    input += '\0';
+    input += std::to_string(stamp->mtime);
+    input += '\0';
+    input += parameters;
+    return Sha256::hex(input);
+}
+
+std::optional<fs::path> TranscodeCache::lookup(const std::string& key) {
+    std::optional<fs::path> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) return std::nullopt;
+
+        it->second.lastAccess = nowSeconds();
+        dirty_ = true;
+        result = directory_ / it->second.name;
+    }
+    saveIndexIfStale();
+    return result;
+}
+
+fs::path TranscodeCache::stagingPath(const std::string& key) const {
+    return directory_ / (key + kStagingSuffix);
+}
+
+std::optional<fs::path> TranscodeCache::publish(const std::string& key, const std::string& extension) {
+    fs::path staged = stagingPath(key);
+    fs::path target = directory_ / (key + extension);
+
+    std::error_code ec;
+    fs::remove_all(target, ec);  // Left over from an earlier run; rename won't replace a directory
+    fs::rename(staged, target, ec);
+    if (ec) {
+        std::cerr << "[Cache] Cannot publish " << staged << ": " << ec.message() << std::endl;
+        return std::nullopt;
+    }
+
+    uint64_t size = diskUsage(target);
+    std::vector<fs::path> victims;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& entry = entries_[key];
+        totalBytes_ = totalBytes_ - entry.size + size;
+        entry.name = target.filename().string();
+        entry.size = size;
+        entry.lastAccess = nowSeconds();
+        victims = evict(key);
+    }
+
+    for (const auto& victim : victims) {
+        std::cout << "[Cache] Evicting " << victim.filename() << std::endl;
+        fs::remove_all(victim, ec);
+    }
+    saveIndex();
+
+    std::cout << "[Cache] Published " << target.filename() << " (" << size / (1024 * 1024) << " MB)" << std::endl;
+    return target;
+}
+
+void TranscodeCache::touch(const fs::path& output) {
+    if (output.parent_path() != directory_) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(output.stem().string());
+        if (it == entries_.end()) return;
+        it->second.lastAccess = nowSeconds();
+        dirty_ = true;
+    }
+    saveIndexIfStale();
+}
+
+json TranscodeCache::toJson() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {
+        {"directory", directory_.string()},
+        {"max_bytes", maxBytes_},
+        {"used_bytes", totalBytes_},
+        {"entries", entries_.size()}
+    };
+}
+
+void TranscodeCache::load() {
+    std::ifstream file(directory_ / kIndexFile);
+    if (!file) return;
+
+    try {
+        json j;
+        file >> j;
+        for (const auto& e : j.value("entries", json::array())) {
+            Entry entry;
+            entry.name = e.value("name", "");
+            entry.size = e.value("size", uint64_t(0));
+            entry.lastAccess = e.value("last_access", int64_t(0));
+
+            // Entries deleted behind our back are forgotten
+            std::error_code ec;
+            if (entry.name.empty() || !fs::exists(directory_ / entry.name, ec)) continue;
+
+            totalBytes_ += entry.size;
+            entries_[e.value("key", "")] = std::move(entry);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[Cache] Ignoring unreadable index: " << e.what() << std::endl;
+        entries_.clear();
+        totalBytes_ = 0;
+    }
+}
+
+void TranscodeCache::removeOrphans() {
+    // Anything not in the index is a staging leftover from an interrupted
+    // transcode or output whose entry was lost; its size is unaccounted
+    std::vector<fs::path> orphans;
+    std::error_code ec;
+    for (fs::directory_iterator it(directory_, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string name = it->path().filename().string();
+        if (name == kIndexFile || name == std::string(kIndexFile) + ".tmp") continue;
+
+        auto entry = entries_.find(it->path().stem().string());
+        if (entry == entries_.end() || entry->second.name != name) {
+            orphans.push_back(it->path());
+        }
+    }
+
+    for (const auto& orphan : orphans) {
+        fs::remove_all(orphan, ec);
+    }
+    if (!orphans.empty()) {
+        std::cout << "[Cache] Removed " << orphans.size() << " incomplete or unindexed outputs" << std::endl;
+    }
+}
+
+std::vector<fs::path> TranscodeCache::evict(const std::string& keep) {
+    std::vector<fs::path> victims;
+    if (totalBytes_ <= maxBytes_) return victims;
+
+    std::vector<std::pair<int64_t, std::string>> byAge;
+    for (const auto& [key, entry] : entries_) {
+        if (key != keep) byAge.emplace_back(entry.lastAccess, key);
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    for (const auto& [lastAccess, key] : byAge) {
+        if (totalBytes_ <= maxBytes_) break;
+        auto it = entries_.find(key);
+        totalBytes_ -= it->second.size;
+        victims.push_back(directory_ / it->second.name);
+        entries_.erase(it);
+    }
+    dirty_ = true;
+    return victims;
+}
+
+void TranscodeCache::saveIndexIfStale() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!dirty_ || std::chrono::steady_clock::now() - lastSave_ < kIndexSaveInterval) return;
+    }
+    saveIndex();
+}
+
+void TranscodeCache::saveIndex() {
+    std::lock_guard<std::mutex> writeLock(writeMutex_);
+
+    json j;
+    j["entries"] = json::array();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [key, entry] : entries_) {
+            j["entries"].push_back({
+                {"key", key},
+                {"name", entry.name},
+                {"size", entry.size},
+                {"last_access", entry.lastAccess}
+            });
+        }
+        dirty_ = false;
+        lastSave_ = std::chrono::steady_clock::now();
+    }
+
+    fs::path indexFile = directory_ / kIndexFile;
+    fs::path tmpFile = indexFile;
+    tmpFile += ".tmp";
+    {
+        std::ofstream file(tmpFile, std::ios::trunc);
+        if (!file) {
+            std::cerr << "[Cache] Cannot write " << tmpFile << std::endl;
+            return;
+        }
+        file << j.dump();
+    }
+
+    std::error_code ec;
+    fs::rename(tmpFile, indexFile, ec);
+    if (ec) {
+        std::cerr << "[Cache] Cannot replace " << indexFile << ": " << ec.message() << std::endl;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <optional>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Disk cache for transcoded renditions (HLS segment directories and legacy
+// MP4 files) with a byte budget and least-recently-used eviction.
+//
+// Outputs are written to a staging path and renamed into place once
+// complete, so a cached entry is never partial. Entries are keyed by a
+// SHA-256 of the source path, size, mtime and transcode parameters; the
+// index of entries (sizes and access times) is kept in the cache directory
+// so renditions survive restarts.
+class TranscodeCache {
+public:
+    TranscodeCache(const std::filesystem::path& directory, uint64_t maxBytes);
+    ~TranscodeCache();
+
+    TranscodeCache(const TranscodeCache&) = delete;
+    TranscodeCache& operator=(const TranscodeCache&) = delete;
+
+    // Key for a rendition of source made with the given parameters.
+    // Empty if the source cannot be stat'ed.
+    static std::string key(const std::filesystem::path& source, const std::string& parameters);
+
+    // Published output for a key, marking it as used
+    std::optional<std::filesystem::path> lookup(const std::string& key);
+
+    // Where the output for a key is written before it is published
+    std::filesystem::path stagingPath(const std::string& key) const;
+
+    // Move staged output into place as <key><extension> ("" for HLS
+    // directories), account its size and evict old entries over budget.
+    // Returns the published path, or nullopt if the rename failed.
+    std::optional<std::filesystem::path> publish(const std::string& key, const std::string& extension);
+
+    // Record an access to a published output (paths outside the cache are ignored)
+    void touch(const std::filesystem::path& output);
+
+    // Budget, usage and entry count for the API
+    json toJson() const;
+
+private:
+    struct Entry {
+        std::string name;     // File or directory name inside the cache directory
+        uint64_t size = 0;
+        int64_t lastAccess = 0;  // Seconds since epoch
+    };
+
+    void load();
+    void removeOrphans();
+    // Drop least recently used entries (except `keep`) until within budget.
+    // Returns the paths to delete; called with mutex_ held.
+    std::vector<std::filesystem::path> evict(const std::string& keep);
+    void saveIndex();
+    void saveIndexIfStale();
+
+    const std::filesystem::path directory_;
+    const uint64_t maxBytes_;
+
+    mutable std::mutex mutex_;
+    std::mutex writeMutex_;  // serializes writers of the index file
+    std::map<std::string, Entry> entries_;
+    uint64_t totalBytes_ = 0;
+    bool dirty_ = false;
+    std::chrono::steady_clock::time_point lastSave_;
+};
@@ -0,0 +1,77 @@
+#include "transcode_jobs.h"
+
+const char* jobStateName(JobState state) {
+    switch (state) {
+        case JobState::Pending: return "pending";
+        case JobState::Running: return "running";
+        case JobState::Ready:   return "ready";
+        case JobState::Failed:  return "failed";
+    }
+    return "unknown";
+}
+
+JobState TranscodeJob::state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+std::filesystem::path TranscodeJob::output() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return output_;
+}
+
+void TranscodeJob::setState(JobState state) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state_ = state;
+    }
+    cv_.notify_all();
+}
+
+void TranscodeJob::setOutput(const std::filesystem::path& output) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    output_ = output;
+}
+
+JobState TranscodeJob::waitUntilFinished(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, timeout, [this]() {
+        return state_ == JobState::Ready || state_ == JobState::Failed;
+    });
+    return state_;
+}
+
+JobState TranscodeJob::waitUntilStarted(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, timeout, [this]() {
+        return state_ != JobState::Pending;
+    });
+    return state_;
+}
+
+std::shared_ptr<TranscodeJob> TranscodeJobRegistry::acquire(const std::string& key, bool& created) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = jobs_.find(key);
+    if (it != jobs_.end()) {
+        JobState state = it->second->state();
+        // A finished job is only reusable while its output still exists
+        std::error_code ec;
+        bool outputGone = state == JobState::Ready && !std::filesystem::exists(it->second->output(), ec);
+        if (state != JobState::Failed && !outputGone) {
+            created = false;
+            return it->second;
+        }
+    }
+
+    auto job = std::make_shared<TranscodeJob>(key);
+    jobs_[key] = job;
+    created = true;
+    return job;
+}
+
+std::shared_ptr<TranscodeJob> TranscodeJobRegistry::find(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(key);
+    return it != jobs_.end() ? it->second : nullptr;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <filesystem>
+
+// Lifecycle of a transcode job
+enum class JobState {
+    Pending,  // Created or waiting in the scheduler queue
+    Running,  // Picked up by a worker, output may be partially available
+    Ready,    // Output complete
+    Failed
+};
+
+const char* jobStateName(JobState state);
+
+// One transcode (HLS stream or legacy MP4) for one title.
+// All requests for the same title share the same job object.
+class TranscodeJob {
+public:
+    explicit TranscodeJob(std::string key) : key_(std::move(key)) {}
+
+    const std::string& key() const { return key_; }
+
+    JobState state() const;
+    std::filesystem::path output() const;
+
+    // Transition to a new state and wake every waiter
+    void setState(JobState state);
+    void setOutput(const std::filesystem::path& output);
+
+    // Block until the job leaves Pending/Running or the timeout expires.
+    // Returns the state observed on return.
+    JobState waitUntilFinished(std::chrono::milliseconds timeout);
+
+    // Block until the job is no longer Pending (a worker picked it up or it failed)
+    JobState waitUntilStarted(std::chrono::milliseconds timeout);
+
+private:
+    const std::string key_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    JobState state_ = JobState::Pending;
+    std::filesystem::path output_;
+};
+
+// Registry of transcode jobs keyed by title.
+// The registry lock only guards the map and is never held while probing or
+// transcoding, so requests for different titles never block each other.
+class TranscodeJobRegistry {
+public:
+    // Get the job for a key, creating a fresh Pending job if there is none,
+    // the previous attempt failed or its output has since been deleted (e.g.
+    // evicted from the transcode cache). `created` is set when the caller
+    // owns the new job and is responsible for starting it.
+    std::shared_ptr<TranscodeJob> acquire(const std::string& key, bool& created);
+
+    // Existing job for a key, or nullptr
+    std::shared_ptr<TranscodeJob> find(const std::string& key) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<TranscodeJob>> jobs_;
+};
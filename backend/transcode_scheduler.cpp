@@ -0,0 +1,127 @@
+#include "transcode_scheduler.h"
+#include <algorithm>
+#include <iostream>
+
+TranscodeScheduler::TranscodeScheduler(const TranscodeLimits& limits) {
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    if (cores <= 0) cores = 1;
+
+    // One libx264 encode keeps about four cores busy
+    maxConcurrent_ = limits.maxConcurrent > 0 ? limits.maxConcurrent : std::max(1, cores / 4);
+    maxQueued_ = std::max(0, limits.maxQueued);
+    threadsPerJob_ = limits.threadsPerJob > 0 ? limits.threadsPerJob : std::max(1, cores / maxConcurrent_);
+
+    std::cout << "[Scheduler] " << maxConcurrent_ << " concurrent transcodes, "
+              << threadsPerJob_ << " threads each, queue limit " << maxQueued_ << std::endl;
+
+    for (int i = 0; i < maxConcurrent_; i++) {
+        workers_.emplace_back(&TranscodeScheduler::workerLoop, this);
+    }
+}
+
+TranscodeScheduler::~TranscodeScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+bool TranscodeScheduler::submit(const std::shared_ptr<TranscodeJob>& job, TranscodePriority priority, Work work) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Admission control: only queue if a worker will get to it soon
+        bool workerFree = static_cast<int>(running_.size()) < maxConcurrent_ && queue_.empty();
+        if (!workerFree && static_cast<int>(queue_.size()) >= maxQueued_) {
+            std::cerr << "[Scheduler] Queue full, rejecting " << job->key() << std::endl;
+            return false;
+        }
+
+        queue_.insert(Entry{priority, nextSequence_++, job, std::move(work)});
+        std::cout << "[Scheduler] Queued " << job->key() << " ("
+                  << (priority == TranscodePriority::Interactive ? "interactive" : "background")
+                  << ", " << queue_.size() << " waiting)" << std::endl;
+    }
+    cv_.notify_one();
+    return true;
+}
+
+int TranscodeScheduler::queuePosition(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int position = 1;
+    for (const auto& entry : queue_) {
+        if (entry.job->key() == key) return position;
+        position++;
+    }
+    return 0;
+}
+
+int TranscodeScheduler::retryAfterSeconds() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Rough estimate: every full round of workers frees slots within ~5s for
+    // copy-mode jobs; this only needs to keep clients from hammering us
+    return 5 * (1 + static_cast<int>(queue_.size()) / maxConcurrent_);
+}
+
+json TranscodeScheduler::toJson() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    json j;
+    j["max_concurrent"] = maxConcurrent_;
+    j["max_queued"] = maxQueued_;
+    j["threads_per_job"] = threadsPerJob_;
+
+    j["running"] = json::array();
+    for (const auto& job : running_) {
+        j["running"].push_back({
+            {"key", job->key()},
+            {"state", jobStateName(job->state())}
+        });
+    }
+
+    j["queued"] = json::array();
+    int position = 1;
+    for (const auto& entry : queue_) {
+        j["queued"].push_back({
+            {"key", entry.job->key()},
+            {"position", position++},
+            {"priority", entry.priority == TranscodePriority::Interactive ? "interactive" : "background"}
+        });
+    }
+
+    return j;
+}
+
+void TranscodeScheduler::workerLoop() {
+    while (true) {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (stopping_) return;
+
+            entry = *queue_.begin();
+            queue_.erase(queue_.begin());
+            running_.push_back(entry.job);
+        }
+
+        entry.job->setState(JobState::Running);
+
+        bool ok = false;
+        try {
+            ok = entry.work(threadsPerJob_);
+        } catch (const std::exception& e) {
+            std::cerr << "[Scheduler] Job " << entry.job->key() << " threw: " << e.what() << std::endl;
+        }
+        entry.job->setState(ok ? JobState::Ready : JobState::Failed);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_.erase(std::find(running_.begin(), running_.end(), entry.job));
+        }
+    }
+}
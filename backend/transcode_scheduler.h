@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "transcode_jobs.h"
+
+using json = nlohmann::json;
+
+// Lower value runs first
+enum class TranscodePriority {
+    Interactive = 0,  // A viewer is waiting for playback to start
+    Background = 1    // Whole-file conversions and other batch work
+};
+
+// Scheduler limits; zero means "derive from core count"
+struct TranscodeLimits {
+    int maxConcurrent = 0;   // ffmpeg processes running at once
+    int maxQueued = 8;       // jobs allowed to wait before new ones are rejected
+    int threadsPerJob = 0;   // -threads passed to each ffmpeg
+};
+
+// Bounded worker pool that runs transcode jobs by priority.
+// At most maxConcurrent jobs run at once; further jobs wait in a priority
+// queue and submissions beyond maxQueued are rejected so the caller can
+// answer 503 immediately instead of piling up ffmpeg processes.
+class TranscodeScheduler {
+public:
+    // Work function; receives the ffmpeg thread budget and returns success
+    using Work = std::function<bool(int threads)>;
+
+    explicit TranscodeScheduler(const TranscodeLimits& limits);
+    ~TranscodeScheduler();
+
+    TranscodeScheduler(const TranscodeScheduler&) = delete;
+    TranscodeScheduler& operator=(const TranscodeScheduler&) = delete;
+
+    // Queue a job. On completion the job is marked Ready or Failed from the
+    // work result. Returns false (job untouched) if the queue is full.
+    bool submit(const std::shared_ptr<TranscodeJob>& job, TranscodePriority priority, Work work);
+
+    // 1-based position in the queue, 0 if running or not queued
+    int queuePosition(const std::string& key) const;
+
+    // Suggested Retry-After for rejected or still-queued requests
+    int retryAfterSeconds() const;
+
+    int maxConcurrent() const { return maxConcurrent_; }
+    int threadsPerJob() const { return threadsPerJob_; }
+
+    // Running and queued jobs for the API
+    json toJson() const;
+
+private:
+    struct Entry {
+        TranscodePriority priority;
+        uint64_t sequence;
+        std::shared_ptr<TranscodeJob> job;
+        Work work;
+
+        bool operator<(const Entry& other) const {
+            if (priority != other.priority) return priority < other.priority;
+            return sequence < other.sequence;
+        }
+    };
+
+    void workerLoop();
+
+    int maxConcurrent_;
+    int maxQueued_;
+    int threadsPerJob_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::set<Entry> queue_;
+    std::vector<std::shared_ptr<TranscodeJob>> running_;
+    uint64_t nextSequence_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
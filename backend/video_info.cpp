@@ -1,4 +1,5 @@
 #include "video_info.h"
+#include "probe_cache.h"
 #include <cstdlib>
 #include <sstream>
 #include <iostream>
@@ -8,6 +9,9 @@
 #include <algorithm>
 #include <chrono>
 
+// ffprobe results shared by /api/video/info, /hls/ and /legacy/
+static ProbeCache probeCache;
+
 // Execute command and capture output
 static std::string executeCommand(const std::string& command) {
     std::array<char, 128> buffer;
@@ -153,9 +157,22 @@ json VideoFileInfo::toJson() const {
     return j;
 }
 
+void VideoInfoAnalyzer::enableCache(const std::string& cacheFile) {
+    probeCache.open(cacheFile);
+}
+
 std::optional<VideoFileInfo> VideoInfoAnalyzer::analyze(const std::string& videoPath) {
     std::cout << "[VideoInfo] Analyzing video: " << videoPath << std::endl;
 
+    // Skip ffprobe entirely if the file is unchanged since it was last probed
+    auto stamp = FileStamp::of(videoPath);
+    if (stamp) {
+        if (auto cached = probeCache.get(videoPath, *stamp)) {
+            std::cout << "[VideoInfo] Probe cache hit" << std::endl;
+            return parseFFProbeOutput(*cached);
+        }
+    }
+
     // Build ffprobe command to get JSON output with timeout
     std::ostringstream cmd;
     cmd << "timeout 10 ffprobe -v quiet -print_format json -show_format -show_streams "
@@ -179,6 +196,10 @@ std::optional<VideoFileInfo> VideoInfoAnalyzer::analyze(const std::string& video
 
     auto result = parseFFProbeOutput(output);
     if (result) {
+        if (stamp) {
+            probeCache.put(videoPath, *stamp, output);
+        }
+
         std::cout << "[VideoInfo] Successfully parsed video info:" << std::endl;
         std::cout << "  - Video streams: " << result->video_streams.size() << std::endl;
         std::cout << "  - Audio streams: " << result->audio_streams.size() << std::endl;
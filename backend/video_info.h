@@ -82,8 +82,12 @@ struct VideoFileInfo {
 class VideoInfoAnalyzer {
 public:
     // Analyze a video file and return detailed codec/format information
+    // Results are cached by path + size + mtime, so unchanged files are never re-probed
     static std::optional<VideoFileInfo> analyze(const std::string& videoPath);
 
+    // Persist the probe cache to a file so it survives restarts
+    static void enableCache(const std::string& cacheFile);
+
 private:
     // Parse ffprobe JSON output
     static std::optional<VideoFileInfo> parseFFProbeOutput(const std::string& jsonOutput);